@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+#include "Types.h"
+
+/*
+ * The indicative uncross of a call auction (OrderBook::GetAuctionInfo()): the single price at which the crossing part
+ * of the book trades the most, as OrderBook::Uncross() would execute it now.
+ * Icebergs count with their reserve: the uncross takes it slice by slice, like a sweep does.
+ */
+struct AuctionInfo{
+    Price price_{ Constants::InvalidPrice };  // InvalidPrice if the book does not cross
+    std::uint64_t volume_{};  // quantity traded at price_
+    std::uint64_t surplus_{};  // quantity of surplusSide_ at price_ or better left over after the uncross
+    Side surplusSide_{ Side::Buy };
+
+    bool Crosses() const { return volume_ != 0; }
+};
@@ -0,0 +1,261 @@
+#include <algorithm> // for std::max
+
+#include "BookManager.h"
+#include "ThreadAffinity.h"
+
+namespace {
+    OrderBookConfig SingleWriter(OrderBookConfig config){
+        config.singleWriter_ = true;
+        return config;
+    }
+
+    // commands taken from a shard queue before looking at the shutdown flag / the clock again.
+    constexpr std::size_t DrainBatch = 256;
+}
+
+BookManager::BookManager(const BookManagerConfig& config, ResultCallback onResult)
+    : maxShards_{ std::max(config.maxShards_, config.shards_) }
+    , maxSymbols_{ config.maxSymbols_ }
+    , queueCapacity_{ config.queueCapacity_ }
+    , housekeepingInterval_{ config.housekeepingInterval_ }
+    , onResult_{ std::move(onResult) }
+    , slots_{ std::make_unique<SymbolSlot[]>(config.maxSymbols_) }
+    , shards_{ std::make_unique<std::unique_ptr<Shard>[]>(maxShards_) }
+{
+    for (std::size_t i = 0; i < config.shards_; ++i){
+        StartShard(i < config.shardCpus_.size() ? config.shardCpus_[i] : -1, false);
+    }
+}
+
+BookManager::~BookManager(){
+    const std::size_t shards = Shards();
+    for (std::size_t i = 0; i < shards; ++i){
+        shards_[i]->shutdown_.store(true, std::memory_order_release);
+    }
+    for (std::size_t i = 0; i < shards; ++i){
+        if (shards_[i]->thread_.joinable()){
+            shards_[i]->thread_.join();
+        }
+    }
+}
+
+bool BookManager::AddSymbol(SymbolId symbol, const OrderBookConfig& config){
+    std::scoped_lock adminLock{ adminMutex_ };
+
+    if (symbol >= maxSymbols_) return false;
+
+    auto& slot = slots_[symbol];
+    if (slot.shard_.load(std::memory_order_acquire) != Unrouted) return false;
+
+    const std::size_t index = LeastLoadedShard();
+    if (index == Shards()) return false;
+    auto& shard = *shards_[index];
+
+    // the book itself is built by the shard on Attach -> on the node of the core it is pinned to, not on this thread's.
+    slot.pendingConfig_ = std::make_unique<OrderBookConfig>(SingleWriter(config));
+    shard.books_.fetch_add(1, std::memory_order_relaxed);
+
+    // Attach goes into the queue before the route is published -> it is ahead of every order for the symbol.
+    Push(shard, ShardCommand{ ShardCommandType::Attach, symbol, {}, nullptr });
+    slot.shard_.store(static_cast<std::uint32_t>(index), std::memory_order_release);
+    return true;
+}
+
+bool BookManager::Submit(SymbolId symbol, const OrderCommand& command){
+    if (symbol >= maxSymbols_) return false;
+    auto& slot = slots_[symbol];
+
+    /*
+     * Announce ourselves in inflight_ before reading the route, and back off while a migration is running.
+     * IsolateSymbol() sets migrating_ and then waits for inflight_ to drain, so (all of it being seq_cst) either
+     * we see migrating_ here, or it sees us and waits until our push has landed in the old shard's queue.
+     */
+    slot.inflight_.fetch_add(1);
+    while (slot.migrating_.load()){
+        slot.inflight_.fetch_sub(1);
+        while (slot.migrating_.load()){
+            std::this_thread::yield();
+        }
+        slot.inflight_.fetch_add(1);
+    }
+
+    const std::uint32_t index = slot.shard_.load(std::memory_order_acquire);
+    const bool pushed = index != Unrouted &&
+        shards_[index]->queue_.TryPush(ShardCommand{ ShardCommandType::Order, symbol, command, nullptr });
+
+    slot.inflight_.fetch_sub(1);
+    return pushed;
+}
+
+std::size_t BookManager::IsolateSymbol(SymbolId symbol, int cpu){
+    std::scoped_lock adminLock{ adminMutex_ };
+
+    if (symbol >= maxSymbols_ || Shards() == maxShards_) return Shards();
+
+    auto& slot = slots_[symbol];
+    const std::uint32_t from = slot.shard_.load(std::memory_order_acquire);
+    if (from == Unrouted) return Shards();
+
+    // 1. hold back new commands for the symbol, and wait for the ones already being routed.
+    slot.migrating_.store(true);
+    while (slot.inflight_.load() != 0){
+        std::this_thread::yield();
+    }
+
+    const std::size_t to = StartShard(cpu, true);
+
+    // 2. let the old shard apply everything queued so far, then drop the symbol.
+    std::atomic<bool> detached{ false };
+    Push(*shards_[from], ShardCommand{ ShardCommandType::Detach, symbol, {}, &detached });
+    while (!detached.load(std::memory_order_acquire)){
+        std::this_thread::yield();
+    }
+    shards_[from]->books_.fetch_sub(1, std::memory_order_relaxed);
+
+    // 3. the new shard picks the book up before any command routed to it.
+    shards_[to]->books_.fetch_add(1, std::memory_order_relaxed);
+    Push(*shards_[to], ShardCommand{ ShardCommandType::Attach, symbol, {}, nullptr });
+    slot.shard_.store(static_cast<std::uint32_t>(to), std::memory_order_release);
+
+    slot.migrating_.store(false);
+    return to;
+}
+
+std::size_t BookManager::ShardOf(SymbolId symbol) const {
+    if (symbol >= maxSymbols_) return Shards();
+    const std::uint32_t index = slots_[symbol].shard_.load(std::memory_order_acquire);
+    return index == Unrouted ? Shards() : index;
+}
+
+ShardStats BookManager::GetShardStats(std::size_t shard) const {
+    if (shard >= Shards()) return {};
+
+    const auto& s = *shards_[shard];
+    return ShardStats{
+        s.commands_.load(std::memory_order_relaxed),
+        s.tradeCount_.load(std::memory_order_relaxed),
+        s.books_.load(std::memory_order_relaxed),
+    };
+}
+
+std::uint64_t BookManager::GetSymbolCommands(SymbolId symbol) const {
+    return symbol < maxSymbols_ ? slots_[symbol].commands_.load(std::memory_order_relaxed) : 0;
+}
+
+std::size_t BookManager::StartShard(int cpu, bool dedicated){
+    const std::size_t index = shardCount_.load(std::memory_order_relaxed);
+
+    shards_[index] = std::make_unique<Shard>(queueCapacity_, dedicated);
+    auto& shard = *shards_[index];
+    shard.thread_ = std::thread{ [this, &shard, cpu] { Run(shard, cpu); } };
+
+    shardCount_.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+void BookManager::Run(Shard& shard, int cpu){
+    // pinned and on local memory before the first Attach -> the books of the shard are first touched from this core's node.
+    PinCurrentThread(cpu);
+    if (cpu >= 0){
+        PreferLocalMemory();
+    }
+
+    // the books are single-writer, so this thread commits their journals and expires their orders itself.
+    auto nextHousekeeping = std::chrono::system_clock::now();
+    bool uncommitted = false;  // commands applied since the last housekeeping
+
+    while (true){
+        // read the flag before draining: whatever was queued before shutdown is still applied by the final pass.
+        const bool shutdown = shard.shutdown_.load(std::memory_order_acquire);
+
+        const std::size_t applied = Drain(shard);
+
+        // every housekeeping interval even when every pass applies something -> a steady flow cannot starve the journals or expiry.
+        // When idle, once more right away if anything was applied since, not on every pass: it walks every book of the shard.
+        const auto now = std::chrono::system_clock::now();
+        uncommitted |= applied != 0;
+        bool done = true;
+        if (now >= nextHousekeeping || (applied == 0 && uncommitted)){
+            uncommitted = false;
+            done = Housekeep(shard, now);
+            nextHousekeeping = done ? now + housekeepingInterval_ : now;  // orders still due: another chunk next pass
+        }
+
+        if (applied == 0){
+            if (shutdown) return;
+            if (done){
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+bool BookManager::Housekeep(Shard& shard, Timestamp now){
+    bool done = true;
+    for (const SymbolId symbol : shard.symbols_){
+        auto& book = *slots_[symbol].book_;
+        book.CommitJournal();  // group commit of whatever the book journaled since the last pass
+        done &= book.ExpireOrders(now);
+    }
+    return done;
+}
+
+std::size_t BookManager::Drain(Shard& shard){
+    std::size_t applied = 0;
+    std::uint64_t orders = 0;
+    std::uint64_t trades = 0;
+    ShardCommand command;
+
+    while (applied < DrainBatch && shard.queue_.TryPop(command)){
+        ++applied;
+        auto& slot = slots_[command.symbol_];
+
+        switch (command.type_){
+            case ShardCommandType::Order: {
+                shard.trades_.clear();
+                const OrderResult result = slot.book_->Apply(command.command_, [&shard](const Trade& trade){ shard.trades_.push_back(trade); });
+                ++orders;
+                trades += shard.trades_.size();
+                slot.commands_.store(slot.commands_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                if (onResult_){
+                    onResult_(command.symbol_, command.command_, result, shard.trades_);
+                }
+                break;
+            }
+            case ShardCommandType::Attach:
+                if (slot.pendingConfig_){
+                    slot.book_ = std::make_unique<OrderBook>(*slot.pendingConfig_);
+                    slot.pendingConfig_.reset();
+                }
+                shard.symbols_.push_back(command.symbol_);
+                break;
+            case ShardCommandType::Detach:
+                std::erase(shard.symbols_, command.symbol_);
+                command.detached_->store(true, std::memory_order_release);  // the book is no longer ours
+                break;
+        }
+    }
+
+    shard.commands_.fetch_add(orders, std::memory_order_relaxed);
+    shard.tradeCount_.fetch_add(trades, std::memory_order_relaxed);
+    return applied;
+}
+
+void BookManager::Push(Shard& shard, const ShardCommand& command){
+    while (!shard.queue_.TryPush(command)){
+        std::this_thread::yield();
+    }
+}
+
+std::size_t BookManager::LeastLoadedShard() const {
+    const std::size_t shards = Shards();
+    std::size_t best = shards;
+
+    for (std::size_t i = 0; i < shards; ++i){
+        if (shards_[i]->dedicated_) continue;  // one isolated symbol each
+        if (best == shards || shards_[i]->books_.load(std::memory_order_relaxed) < shards_[best]->books_.load(std::memory_order_relaxed)){
+            best = i;
+        }
+    }
+    return best;
+}
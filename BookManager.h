@@ -0,0 +1,146 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Types.h"
+#include "OrderBook.h"
+#include "OrderBookConfig.h"
+#include "OrderCommand.h"
+#include "MpscQueue.h"
+#include "Trade.h"
+
+struct BookManagerConfig{
+    std::size_t shards_{ 1 };  // worker threads started up front, symbols are spread across them.
+    std::size_t maxShards_{ 64 };  // upper bound including the dedicated shards created by IsolateSymbol().
+    std::size_t maxSymbols_{ 1 << 14 };  // symbol IDs are dense: [0, maxSymbols_)
+    std::size_t queueCapacity_{ 1 << 16 };  // commands per shard queue (rounded up to a power of two).
+    std::vector<int> shardCpus_;  // core to pin shard i to; missing or -1 leaves it to the scheduler.
+
+    // How often a shard commits the journals of its books and expires their orders, loaded or not
+    // (and once more when it goes idle with commands applied since, so they are not left uncommitted until then).
+    std::chrono::milliseconds housekeepingInterval_{ 100 };
+};
+
+struct ShardStats{
+    std::uint64_t commands_{};  // commands applied so far
+    std::uint64_t trades_{};  // trades produced so far
+    std::size_t books_{};  // symbols currently served by the shard
+};
+
+/*
+ * Many OrderBooks, one per symbol, spread over a set of shards.
+ *
+ * A shard is one worker thread with its own MPSC command queue. Every book belongs to exactly one shard
+ * and is single-writer, so matching never takes a lock, and nothing is shared between symbols
+ * except the (read-mostly) routing table entry of each symbol.
+ *
+ * A hot symbol can be moved onto a shard of its own with IsolateSymbol(): its commands are held back for
+ * the duration of the hand-over, so they are still applied in submission order. Such a shard is dedicated to that
+ * symbol -> AddSymbol() never places another one on it.
+ *
+ * ! A book is built by the thread of the shard it is first listed on, once pinned -> its memory is first touched there,
+ * ! i.e., allocated on that core's NUMA node. A book moved by IsolateSymbol() keeps that memory: on another node
+ * ! than its new shard's core, unless the two share one.
+ */
+class BookManager{
+public:
+    // Called on the worker thread of the symbol's shard, once per command -> must be safe to call from several shards at once.
+    using ResultCallback = std::function<void(SymbolId symbol, const OrderCommand& command, OrderResult result, const Trades& trades)>;
+
+    BookManager(const BookManagerConfig& config, ResultCallback onResult);
+
+    BookManager(const BookManager&) = delete;
+    void operator=(const BookManager&) = delete;
+    BookManager(BookManager&&) = delete;
+    void operator=(BookManager&&) = delete;
+
+    // Drains every shard queue, then stops the workers.
+    ~BookManager();
+
+    // List a new symbol on the least loaded shard (dedicated ones aside). Returns false if the ID is out of range or already listed.
+    bool AddSymbol(SymbolId symbol, const OrderBookConfig& config);
+
+    // Route a command to the shard serving the symbol. Thread-safe, lock-free.
+    // Returns false if the symbol is not listed or its shard queue is full.
+    bool Submit(SymbolId symbol, const OrderCommand& command);
+
+    // Move the symbol onto a new shard of its own, pinned to the given core (-1 = unpinned).
+    // Returns the index of the new shard, or Shards() if the symbol is not listed or maxShards_ is reached.
+    std::size_t IsolateSymbol(SymbolId symbol, int cpu = -1);
+
+    std::size_t Shards() const { return shardCount_.load(std::memory_order_acquire); }
+    std::size_t ShardOf(SymbolId symbol) const;  // Shards() if the symbol is not listed
+    ShardStats GetShardStats(std::size_t shard) const;
+    std::uint64_t GetSymbolCommands(SymbolId symbol) const;  // to find the hot symbols worth isolating
+
+private:
+    static constexpr std::size_t CacheLine = 64;
+    static constexpr std::uint32_t Unrouted = static_cast<std::uint32_t>(-1);
+
+    enum class ShardCommandType{
+        Order,  // apply command_ to the symbol's book
+        Attach,  // the shard now serves the symbol, building its book first if it is new
+        Detach,  // the shard stops serving the symbol, then sets *detached_
+    };
+
+    struct ShardCommand{
+        ShardCommandType type_{ ShardCommandType::Order };
+        SymbolId symbol_{};
+        OrderCommand command_{};
+        std::atomic<bool>* detached_{ nullptr };
+    };
+
+    // ! one cache line per symbol -> submitting to one symbol never bounces the line of another.
+    struct alignas(CacheLine) SymbolSlot{
+        std::atomic<std::uint32_t> shard_{ Unrouted };
+        std::atomic<std::uint32_t> inflight_{ 0 };  // producers between reading shard_ and pushing
+        std::atomic<bool> migrating_{ false };  // set while IsolateSymbol() hands the book over
+        std::atomic<std::uint64_t> commands_{ 0 };  // written by the owning shard only
+        std::unique_ptr<OrderBook> book_;  // only touched by the owning shard's thread
+        std::unique_ptr<OrderBookConfig> pendingConfig_;  // set by AddSymbol(), turned into book_ by the shard's Attach
+    };
+
+    struct Shard{
+        Shard(std::size_t queueCapacity, bool dedicated) : queue_{ queueCapacity }, dedicated_{ dedicated } {}
+
+        MpscQueue<ShardCommand> queue_;
+        const bool dedicated_;  // started by IsolateSymbol() for one symbol
+        std::vector<SymbolId> symbols_;  // only touched by the shard's thread
+        Trades trades_;  // scratch buffer reused for every command, only touched by the shard's thread
+
+        std::atomic<std::uint64_t> commands_{ 0 };
+        std::atomic<std::uint64_t> tradeCount_{ 0 };
+        std::atomic<std::size_t> books_{ 0 };
+        std::atomic<bool> shutdown_{ false };
+        std::thread thread_;
+    };
+
+    std::size_t StartShard(int cpu, bool dedicated);
+    void Run(Shard& shard, int cpu);
+    std::size_t Drain(Shard& shard);
+    void Push(Shard& shard, const ShardCommand& command);  // admin path: spins until the queue has room
+    std::size_t LeastLoadedShard() const;  // Shards() if every shard is dedicated
+    bool Housekeep(Shard& shard, Timestamp now);  // journal commit + one expiry chunk per book, true once nothing more is due
+
+    const std::size_t maxShards_;
+    const std::size_t maxSymbols_;
+    const std::size_t queueCapacity_;
+    const std::chrono::milliseconds housekeepingInterval_;
+    ResultCallback onResult_;
+
+    std::unique_ptr<SymbolSlot[]> slots_;
+
+    // fixed-size table, filled up to shardCount_ -> producers can index it while IsolateSymbol() adds a shard.
+    std::unique_ptr<std::unique_ptr<Shard>[]> shards_;
+    std::atomic<std::size_t> shardCount_{ 0 };
+
+    // serialises AddSymbol() / IsolateSymbol() only, never taken on the order path.
+    std::mutex adminMutex_;
+};
@@ -0,0 +1,89 @@
+#include <algorithm> // for std::push_heap, std::pop_heap
+#include <bit>  // for std::bit_ceil
+
+#include "ExpiryWheel.h"
+
+namespace {
+    // std::*_heap build a max-heap -> invert the order to keep the nearest expiry on top.
+    struct Later{
+        template <typename FarEntry>
+        bool operator()(const FarEntry& lhs, const FarEntry& rhs) const { return lhs.tick_ > rhs.tick_; }
+    };
+}
+
+ExpiryWheel::ExpiryWheel(std::chrono::nanoseconds tick, std::size_t slots, Timestamp start)
+    : tick_{ tick.count() > 0 ? tick : std::chrono::nanoseconds{ 1 } }
+    , mask_{ std::bit_ceil(std::max<std::size_t>(slots, 1)) - 1 }  // power of two -> the bucket of a tick is a mask away.
+    , buckets_(mask_ + 1)
+    , cursor_{ TickOf(start) }
+{}
+
+std::int64_t ExpiryWheel::TickOf(Timestamp time) const {
+    const auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch());
+    const std::int64_t tick = sinceEpoch.count() / tick_.count();
+    return (sinceEpoch.count() % tick_.count() < 0) ? tick - 1 : tick;  // round towards the past
+}
+
+std::int64_t ExpiryWheel::DueTick(Timestamp expiry) const {
+    // an expiry on a tick boundary is due at that tick, anything inside a tick at the next one.
+    const std::int64_t tick = TickOf(expiry);
+    return Timestamp{ std::chrono::duration_cast<Timestamp::duration>(tick_ * tick) } == expiry ? tick : tick + 1;
+}
+
+void ExpiryWheel::Schedule(OrderId orderId, Timestamp expiry){
+    const Entry entry{ orderId, expiry };
+    const std::int64_t tick = DueTick(expiry);
+
+    if (tick > cursor_ + static_cast<std::int64_t>(mask_)){
+        far_.push_back(FarEntry{ tick, entry });
+        std::push_heap(far_.begin(), far_.end(), Later{});
+        return;
+    }
+
+    Place(tick, entry);
+}
+
+void ExpiryWheel::Place(std::int64_t tick, const Entry& entry){
+    // already past -> put it under the cursor, it is picked up by the next Collect().
+    Bucket(std::max(tick, cursor_)).push_back(entry);
+    ++wheelCount_;
+}
+
+void ExpiryWheel::Cascade(){
+    const std::int64_t horizon = cursor_ + static_cast<std::int64_t>(mask_);
+
+    while (!far_.empty() && far_.front().tick_ <= horizon){
+        std::pop_heap(far_.begin(), far_.end(), Later{});
+        Place(far_.back().tick_, far_.back().entry_);
+        far_.pop_back();
+    }
+}
+
+bool ExpiryWheel::Collect(Timestamp now, std::size_t maxEntries, std::vector<Entry>& due){
+    const std::int64_t nowTick = TickOf(now);
+    std::size_t collected = 0;
+
+    while (cursor_ <= nowTick){
+        if (wheelCount_ == 0){
+            // nothing in the wheel -> jump straight to the next far expiry instead of turning it tick by tick.
+            cursor_ = far_.empty() ? nowTick + 1 : std::min(nowTick + 1, std::max(cursor_, far_.front().tick_));
+            Cascade();
+            if (wheelCount_ == 0) return true;
+            continue;
+        }
+
+        auto& bucket = Bucket(cursor_);
+        while (!bucket.empty()){
+            if (collected == maxEntries) return false;  // the rest stays in the bucket for the next call
+
+            due.push_back(bucket.back());
+            bucket.pop_back();
+            --wheelCount_;
+            ++collected;
+        }
+
+        ++cursor_;
+        Cascade();
+    }
+    return true;
+}
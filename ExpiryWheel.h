@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Types.h"
+
+/*
+ * Timer wheel of order expiries (GoodForDay cutoff, GoodTillDate).
+ *
+ * Time is cut into ticks of a fixed duration. The wheel holds one bucket per tick for the next `slots` ticks,
+ * so scheduling an expiry is a push_back into the bucket of its tick, and collecting the due ones only touches
+ * the buckets whose tick has passed. Expiries further out than the wheel covers wait in a min-heap
+ * and are moved into their bucket once the wheel has turned far enough (the second level of the hierarchy).
+ *
+ * An expiry is never reported early, and at most one tick late.
+ *
+ * ! Entries are not removed when the order is cancelled or filled: the book checks each collected entry
+ * ! against its orders and drops the stale ones. This keeps cancel O(1) and the wheel free of back-pointers.
+ */
+class ExpiryWheel{
+public:
+    struct Entry{
+        OrderId orderId_{};
+        Timestamp expiry_{};
+    };
+
+    ExpiryWheel(std::chrono::nanoseconds tick, std::size_t slots, Timestamp start);
+
+    void Schedule(OrderId orderId, Timestamp expiry);
+
+    /*
+     * Append the entries due at `now` to `due`, at most maxEntries of them -> the caller bounds the work per call.
+     * Returns true if nothing due is left behind, false if the limit was hit and it should be called again.
+     */
+    bool Collect(Timestamp now, std::size_t maxEntries, std::vector<Entry>& due);
+
+    std::size_t size() const { return wheelCount_ + far_.size(); }  // scheduled entries, stale ones included
+
+private:
+    struct FarEntry{
+        std::int64_t tick_{};
+        Entry entry_{};
+    };
+
+    std::int64_t TickOf(Timestamp time) const;  // the tick during which `time` falls
+    std::int64_t DueTick(Timestamp expiry) const;  // the first tick at which the expiry has passed
+    std::vector<Entry>& Bucket(std::int64_t tick) { return buckets_[static_cast<std::size_t>(tick) & mask_]; }
+
+    void Place(std::int64_t tick, const Entry& entry);
+    void Cascade();  // move the far entries now covered by the wheel into their bucket
+
+    std::chrono::nanoseconds tick_;
+    std::size_t mask_;
+
+    // ! every bucket keeps its capacity once drained -> a warm wheel schedules without allocating.
+    std::vector<std::vector<Entry>> buckets_;
+    std::size_t wheelCount_{};
+
+    // every tick before cursor_ has been fully collected.
+    std::int64_t cursor_;
+
+    std::vector<FarEntry> far_;  // min-heap on tick_
+};
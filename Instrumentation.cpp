@@ -0,0 +1,178 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "Instrumentation.h"
+
+namespace Instrumentation{
+    const char* ProbeName(Probe probe){
+        switch (probe){
+            case Probe::AddOrder: return "add_order";
+            case Probe::CancelOrder: return "cancel_order";
+            case Probe::ModifyOrder: return "modify_order";
+            case Probe::Apply: return "apply";
+            case Probe::Batch: return "batch";
+            case Probe::ExpireOrders: return "expire_orders";
+            case Probe::LockWait: return "lock_wait";
+            case Probe::Match: return "match";
+            case Probe::Uncross: return "uncross";
+            case Probe::Count: break;
+        }
+        return "unknown";
+    }
+}
+
+#if ORDERBOOK_INSTRUMENTATION
+
+namespace {
+    using namespace Instrumentation;
+
+    /*
+     * One thread's histograms. Only the owning thread writes, with a relaxed load + store (no locked instruction),
+     * and the counters are atomics so a scrape from another thread is race-free (if a recording or two behind).
+     */
+    struct ThreadHistograms{
+        std::array<std::array<std::atomic<std::uint64_t>, LatencyHistogram::BucketCount()>, ProbeCount> buckets_{};
+
+        void Add(Probe probe, std::uint64_t nanoseconds){
+            auto& counter = buckets_[static_cast<std::size_t>(probe)][LatencyHistogram::BucketOf(nanoseconds)];
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        void FoldInto(Histograms& histograms) const {
+            for (std::size_t probe = 0; probe < ProbeCount; ++probe){
+                for (std::size_t bucket = 0; bucket < LatencyHistogram::BucketCount(); ++bucket){
+                    histograms[probe].AddToBucket(bucket, buckets_[probe][bucket].load(std::memory_order_relaxed));
+                }
+            }
+        }
+
+        void Clear(){
+            for (auto& probe : buckets_){
+                for (auto& counter : probe){
+                    counter.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+
+    // Every live thread's histograms, plus what the exited ones left behind.
+    struct Registry{
+        std::mutex mutex_;
+        std::vector<ThreadHistograms*> threads_;
+        Histograms retired_;
+
+        static Registry& Get(){
+            static Registry registry;  // ! never destroyed before the thread_locals using it: it is constructed first
+            return registry;
+        }
+    };
+
+    struct ThreadSlot{
+        ThreadHistograms histograms_;
+
+        ThreadSlot(){
+            auto& registry = Registry::Get();
+            std::scoped_lock lock{ registry.mutex_ };
+            registry.threads_.push_back(&histograms_);
+        }
+
+        ~ThreadSlot(){
+            auto& registry = Registry::Get();
+            std::scoped_lock lock{ registry.mutex_ };
+            histograms_.FoldInto(registry.retired_);
+            std::erase(registry.threads_, &histograms_);
+        }
+    };
+
+    ThreadHistograms& Local(){
+        thread_local ThreadSlot slot;
+        return slot.histograms_;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    // rdtsc ticks at a constant rate on anything recent -> measure that rate once against steady_clock.
+    double NanosecondsPerTick(){
+        static const double scale = []{
+            using namespace std::chrono;
+            const auto wallStart = steady_clock::now();
+            const Ticks tickStart = __rdtsc();
+            while (steady_clock::now() - wallStart < milliseconds(10)){}
+            const auto wall = duration_cast<nanoseconds>(steady_clock::now() - wallStart).count();
+            const Ticks ticks = __rdtsc() - tickStart;
+            return ticks > 0 ? static_cast<double>(wall) / static_cast<double>(ticks) : 1.0;
+        }();
+        return scale;
+    }
+#endif
+}
+
+namespace Instrumentation{
+    void Record(Probe probe, Ticks start, Ticks end){
+        const Ticks ticks = end > start ? end - start : 0;  // rdtsc across cores is not strictly monotonic
+#if defined(__x86_64__) || defined(__i386__)
+        const auto nanoseconds = static_cast<std::uint64_t>(static_cast<double>(ticks) * NanosecondsPerTick());
+#else
+        const auto nanoseconds = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::duration{ ticks }).count()
+        );
+#endif
+        Local().Add(probe, nanoseconds);
+    }
+
+    Histograms Snapshot(){
+        auto& registry = Registry::Get();
+        std::scoped_lock lock{ registry.mutex_ };
+
+        Histograms histograms = registry.retired_;
+        for (const auto* thread : registry.threads_){
+            thread->FoldInto(histograms);
+        }
+        return histograms;
+    }
+
+    void Reset(){
+        auto& registry = Registry::Get();
+        std::scoped_lock lock{ registry.mutex_ };
+
+        for (auto& histogram : registry.retired_){
+            histogram.Reset();
+        }
+        for (auto* thread : registry.threads_){
+            thread->Clear();  // racing with the owner's next recording at worst -> that one sample survives the reset
+        }
+    }
+}
+
+#else
+
+namespace Instrumentation{
+    Histograms Snapshot() { return {}; }
+    void Reset() {}
+}
+
+#endif
+
+namespace Instrumentation{
+    std::string Report(){
+        const auto histograms = Snapshot();
+        std::ostringstream out;
+
+        out << "# HELP orderbook_latency_ns Latency of the book's operations, in nanoseconds.\n"
+            << "# TYPE orderbook_latency_ns summary\n";
+        for (std::size_t i = 0; i < ProbeCount; ++i){
+            const auto& histogram = histograms[i];
+            const char* name = ProbeName(static_cast<Probe>(i));
+
+            for (const double quantile : { 0.5, 0.9, 0.99, 0.999, 0.9999 }){
+                out << "orderbook_latency_ns{op=\"" << name << "\",quantile=\"" << quantile << "\"} "
+                    << histogram.Percentile(quantile) << '\n';
+            }
+            out << "orderbook_latency_ns_sum{op=\"" << name << "\"} " << static_cast<std::uint64_t>(histogram.Mean() * static_cast<double>(histogram.Count())) << '\n'
+                << "orderbook_latency_ns_count{op=\"" << name << "\"} " << histogram.Count() << '\n';
+        }
+        return out.str();
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "LatencyHistogram.h"
+
+#if ORDERBOOK_INSTRUMENTATION && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>  // for __rdtsc
+#elif ORDERBOOK_INSTRUMENTATION
+#include <chrono>
+#endif
+
+/*
+ * Latency probes inside the book, compiled out unless ORDERBOOK_INSTRUMENTATION is defined
+ * (CMake: -DORDERBOOK_INSTRUMENTATION=ON). Without it every call below is an empty inline function,
+ * so the probes in the book cost nothing.
+ *
+ * With it, every probe takes a timestamp (rdtsc on x86, steady_clock elsewhere) on the way in and on the way out,
+ * and records the difference into a thread-local histogram -> no sharing, no lock on the recording side.
+ * Snapshot() / Report() fold the histograms of every thread together, from any thread, at any time.
+ */
+namespace Instrumentation{
+    enum class Probe : std::uint8_t{
+        AddOrder,  // public entry points: ingress -> return, lock wait included
+        CancelOrder,
+        ModifyOrder,
+        Apply,
+        Batch,  // AddOrders / CancelOrders / ProcessBatch, the whole batch
+        ExpireOrders,
+        LockWait,  // ingress -> orderMutex_ acquired (locked books only)
+        Match,  // MatchOrders() start -> end
+        Uncross,  // Uncross(): equilibrium price and the whole batch of fills at it
+        Count,
+    };
+
+    inline constexpr std::size_t ProbeCount = static_cast<std::size_t>(Probe::Count);
+    const char* ProbeName(Probe probe);
+
+    using Ticks = std::uint64_t;
+    using Histograms = std::array<LatencyHistogram, ProbeCount>;  // indexed by Probe
+
+#if ORDERBOOK_INSTRUMENTATION
+    inline constexpr bool Enabled = true;
+
+    // inline: the timestamp itself should not cost a call.
+    inline Ticks Now(){
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<Ticks>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    void Record(Probe probe, Ticks start, Ticks end);
+#else
+    inline constexpr bool Enabled = false;
+
+    inline Ticks Now() { return 0; }
+    inline void Record(Probe, Ticks, Ticks) {}
+#endif
+
+    // Every thread's histograms folded together, in nanoseconds (threads that have exited included).
+    Histograms Snapshot();
+
+    // Same, as Prometheus text exposition format (one summary per probe) -> can be served as-is to a scraper.
+    std::string Report();
+
+    // Start every histogram over, e.g., after the warm-up.
+    void Reset();
+
+    // Times the enclosing scope.
+    class ScopedProbe{
+    public:
+        explicit ScopedProbe(Probe probe) : probe_{ probe }, start_{ Now() } {}
+        ~ScopedProbe() { Record(probe_, start_, Now()); }
+
+        ScopedProbe(const ScopedProbe&) = delete;
+        void operator=(const ScopedProbe&) = delete;
+
+    private:
+        Probe probe_;
+        Ticks start_;
+    };
+}
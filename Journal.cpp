@@ -0,0 +1,277 @@
+#include <algorithm> // for std::max
+#include <cerrno>
+#include <cstddef> // for offsetof
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Journal.h"
+
+namespace {
+    // FNV-1a: cheap, and good enough to tell a torn record from a written one.
+    std::uint32_t Checksum(const void* data, std::size_t size){
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < size; ++i){
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    constexpr std::size_t ChecksummedBytes = offsetof(JournalRecord, checksum_);
+
+    // write() may stop short, e.g., on a signal -> keep going until everything is out.
+    bool WriteAll(int fd, const void* data, std::size_t size){
+        const auto* bytes = static_cast<const char*>(data);
+        while (size > 0){
+            const ssize_t written = write(fd, bytes, size);
+            if (written < 0){
+                if (errno == EINTR) continue;
+                return false;
+            }
+            bytes += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+}
+
+JournalRecord JournalRecord::Encode(std::uint64_t sequence, Timestamp timestamp, const OrderCommand& command){
+    JournalRecord record;
+    record.sequence_ = sequence;
+    record.timestamp_ = ToEpochNanoseconds(timestamp);
+    record.orderId_ = command.orderId_;
+    record.expiry_ = ToEpochNanoseconds(command.expiry_);
+    record.price_ = command.price_;
+    record.quantity_ = command.quantity_;
+    record.type_ = static_cast<std::uint8_t>(command.type_);
+    record.orderType_ = static_cast<std::uint8_t>(command.orderType_);
+    record.side_ = static_cast<std::uint8_t>(command.side_);
+    record.owner_ = command.owner_;
+    if (command.orderType_ == OrderType::Stop || command.orderType_ == OrderType::StopLimit){
+        record.stopPrice_ = command.stopPrice_;
+    } else {
+        record.displayQuantity_ = command.displayQuantity_;
+    }
+    record.checksum_ = Checksum(&record, ChecksummedBytes);
+    return record;
+}
+
+OrderCommand JournalRecord::Decode() const {
+    OrderCommand command;
+    command.type_ = static_cast<CommandType>(type_);
+    command.orderType_ = static_cast<OrderType>(orderType_);
+    command.orderId_ = orderId_;
+    command.side_ = static_cast<Side>(side_);
+    command.price_ = price_;
+    command.quantity_ = quantity_;
+    command.expiry_ = FromEpochNanoseconds(expiry_);
+    command.owner_ = owner_;
+    if (command.orderType_ == OrderType::Stop || command.orderType_ == OrderType::StopLimit){
+        command.stopPrice_ = stopPrice_;
+    } else {
+        command.displayQuantity_ = displayQuantity_;
+    }
+    return command;
+}
+
+bool JournalRecord::IsValid(std::uint64_t sequence) const {
+    return sequence_ == sequence && checksum_ == Checksum(this, ChecksummedBytes);
+}
+
+namespace {
+    // length of the longest run of valid records from the start -> anything after it was never fully committed.
+    std::size_t ValidRecords(const void* mapping, std::size_t bytes){
+        const auto* record = static_cast<const JournalRecord*>(mapping);
+        const std::size_t stored = bytes / sizeof(JournalRecord);
+
+        std::size_t records = 0;
+        while (records < stored && record[records].IsValid(records)){
+            ++records;
+        }
+        return records;
+    }
+}
+
+std::unique_ptr<Journal> Journal::Open(const std::string& path, const JournalConfig& config){
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return nullptr;
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0){
+        close(fd);
+        return nullptr;
+    }
+
+    std::uint64_t records = 0;
+    const auto bytes = static_cast<std::size_t>(info.st_size);
+    if (bytes >= sizeof(JournalRecord)){
+        void* mapping = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED){
+            close(fd);
+            return nullptr;
+        }
+        records = ValidRecords(mapping, bytes);
+        munmap(mapping, bytes);
+    }
+
+    if (
+        ftruncate(fd, static_cast<off_t>(records * sizeof(JournalRecord))) != 0 ||
+        lseek(fd, 0, SEEK_END) < 0
+    ){
+        close(fd);
+        return nullptr;
+    }
+
+    return std::unique_ptr<Journal>{ new Journal{ fd, config, records } };
+}
+
+Journal::Journal(int fd, const JournalConfig& config, std::uint64_t records)
+    : fd_{ fd }
+    , groupCommit_{ std::max<std::size_t>(config.groupCommit_, 1) }
+    , sync_{ config.sync_ }
+    , next_{ records }
+    , committed_{ records }
+    , writer_{ [this] { Write(); } }
+{
+    buffer_.reserve(groupCommit_);
+}
+
+Journal::~Journal(){
+    Flush();
+    {
+        std::scoped_lock lock{ mutex_ };
+        stop_ = true;
+    }
+    writerWakeUp_.notify_one();
+    writer_.join();
+    close(fd_);
+}
+
+bool Journal::Commit(){
+    std::unique_lock lock{ mutex_ };
+    const bool ok = !failed_;
+    failed_ = false;  // let the writer retry
+
+    if (!buffer_.empty()){
+        pending_.push_back(std::move(buffer_));
+        if (spare_.empty()){
+            buffer_ = Batch{};
+            buffer_.reserve(groupCommit_);
+        } else {
+            buffer_ = std::move(spare_.back());
+            spare_.pop_back();
+        }
+    }
+
+    const bool wake = !pending_.empty();
+    lock.unlock();
+    if (wake){
+        writerWakeUp_.notify_one();
+    }
+    return ok;
+}
+
+bool Journal::Flush(){
+    Commit();
+
+    std::unique_lock lock{ mutex_ };
+    flushed_.wait(lock, [this]{ return pending_.empty() || failed_; });
+    return pending_.empty();
+}
+
+bool Journal::WaitCommitted(std::uint64_t sequence){
+    std::unique_lock lock{ mutex_ };
+    flushed_.wait(lock, [&]{ return CommittedSequence() >= sequence || failed_; });
+    return CommittedSequence() >= sequence;
+}
+
+void Journal::Write(){
+    std::unique_lock lock{ mutex_ };
+    while (true){
+        writerWakeUp_.wait(lock, [this]{ return stop_ || (!pending_.empty() && !failed_); });
+        if (pending_.empty() || failed_) return;  // stopping: the destructor flushed first, whatever is left could not be written
+
+        // the batch stays at the front while it is written -> Flush() keeps waiting for it, Commit() queues behind it.
+        Batch& batch = pending_.front();
+        lock.unlock();
+        const bool written = WriteBatch(batch);
+        lock.lock();
+
+        if (written){
+            committed_.store(committed_.load(std::memory_order_relaxed) + batch.size(), std::memory_order_release);
+            batch.clear();
+            spare_.push_back(std::move(batch));
+            pending_.pop_front();
+        } else {
+            failed_ = true;
+        }
+        flushed_.notify_all();
+    }
+}
+
+bool Journal::WriteBatch(const Batch& batch){
+    if (
+        !WriteAll(fd_, batch.data(), batch.size() * sizeof(JournalRecord)) ||
+        (sync_ && fdatasync(fd_) != 0)
+    ){
+        // ! part of the batch may be in the file already -> put the file back where it was, so a retry does not duplicate it.
+        const auto committed = static_cast<off_t>(CommittedSequence() * sizeof(JournalRecord));
+        if (ftruncate(fd_, committed) == 0){
+            lseek(fd_, 0, SEEK_END);
+        }
+        return false;
+    }
+    return true;
+}
+
+std::size_t Journal::Replay(std::uint64_t fromSequence, const std::function<void(const OrderCommand&)>& apply) const {
+    const std::uint64_t committed = CommittedSequence();
+    if (fromSequence >= committed) return 0;
+
+    const std::size_t bytes = committed * sizeof(JournalRecord);
+    void* mapping = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapping == MAP_FAILED) return 0;
+
+    const auto* records = static_cast<const JournalRecord*>(mapping);
+    std::size_t replayed = 0;
+    for (std::uint64_t sequence = fromSequence; sequence < committed; ++sequence){
+        apply(records[sequence].Decode());
+        ++replayed;
+    }
+
+    munmap(mapping, bytes);
+    return replayed;
+}
+
+std::unique_ptr<JournalView> JournalView::Open(const std::string& path){
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat info{};
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0){
+        mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) return nullptr;
+
+    const auto bytes = static_cast<std::size_t>(info.st_size);
+    madvise(mapping, bytes, MADV_SEQUENTIAL);  // read front to back exactly once
+
+    return std::unique_ptr<JournalView>{ new JournalView{ mapping, bytes, ValidRecords(mapping, bytes) } };
+}
+
+JournalView::JournalView(void* mapping, std::size_t bytes, std::size_t count)
+    : mapping_{ mapping }
+    , bytes_{ bytes }
+    , records_{ static_cast<const JournalRecord*>(mapping) }
+    , count_{ count }
+{}
+
+JournalView::~JournalView(){
+    munmap(mapping_, bytes_);
+}
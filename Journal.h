@@ -0,0 +1,161 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Types.h"
+#include "OrderCommand.h"
+
+struct JournalConfig{
+    std::size_t groupCommit_{ 256 };  // records buffered before Append() hands them to the writer thread by itself
+    bool sync_{ true };  // fdatasync() on every commit -> a committed record survives a power loss, not just a crash
+};
+
+/*
+ * One command as written to the journal: fixed 56 bytes, explicit widths, checksummed
+ * -> a record torn by a crash mid-write is detected (and dropped) on the next Open().
+ */
+struct JournalRecord{
+    std::uint64_t sequence_{};  // position in the journal, from 0
+    std::int64_t timestamp_{};  // when the command was journaled (its batch was started), nanoseconds since the epoch -> replay at recorded timing
+    std::uint64_t orderId_{};
+    std::int64_t expiry_{};  // nanoseconds since the epoch, INT64_MAX = NoExpiry
+    Price price_{};
+    Quantity quantity_{};
+    std::uint8_t type_{};  // CommandType
+    std::uint8_t orderType_{};  // OrderType
+    std::uint8_t side_{};  // Side
+    std::uint8_t reserved_{};
+    OwnerId owner_{};
+    // ! one field, two meanings, picked by orderType_ -> a stop cannot be an iceberg (the book rejects it).
+    union{
+        Price stopPrice_{};  // Stop and StopLimit
+        Quantity displayQuantity_;  // every other order type: iceberg display size, 0 = fully displayed
+    };
+    std::uint32_t checksum_{};  // over every byte before it
+
+    static JournalRecord Encode(std::uint64_t sequence, Timestamp timestamp, const OrderCommand& command);
+    OrderCommand Decode() const;
+    bool IsValid(std::uint64_t sequence) const;
+};
+
+static_assert(sizeof(JournalRecord) == 56);
+
+/*
+ * Append-only write-ahead journal of the commands applied to a book.
+ *
+ * Append() only copies the record into a buffer; Commit() hands the whole buffer to the journal's writer thread,
+ * which writes it with one write() and (optionally) one fdatasync() -> a group commit, instead of a sync per order,
+ * and never on the caller's thread: the matching path does not wait for the disk. Flush() is the waiting version.
+ * The clock is read once per batch (when its first record is appended), not once per record.
+ * The book appends under its own lock, so the journal is in the same order as the book applied the commands.
+ * ! Not thread-safe by itself: one owner (the book) at a time. Only CommittedSequence() and WaitCommitted() may be
+ * ! called from any thread, e.g., a housekeeping one waiting to write a snapshot.
+ */
+class Journal{
+public:
+    // Open (or create) the journal file for appending. A torn or corrupted tail, left by a crash, is truncated away.
+    // Returns nullptr if the file cannot be opened.
+    static std::unique_ptr<Journal> Open(const std::string& path, const JournalConfig& config = {});
+
+    Journal(const Journal&) = delete;
+    void operator=(const Journal&) = delete;
+
+    ~Journal();  // flushes whatever is still buffered, then stops the writer thread
+
+    // Stamped with the time its batch was started.
+    void Append(const OrderCommand& command){
+        if (buffer_.empty()){
+            batchTime_ = std::chrono::system_clock::now();
+        }
+        Append(command, batchTime_);
+    }
+
+    // `timestamp`: when the command was received, e.g., passed by a capture tool.
+    void Append(const OrderCommand& command, Timestamp timestamp){
+        buffer_.push_back(JournalRecord::Encode(next_++, timestamp, command));
+        if (buffer_.size() >= groupCommit_){
+            Commit();
+        }
+    }
+
+    // Hand every buffered record to the writer thread, without waiting for it.
+    // Returns false if a write has failed since the last call: the failed batch is retried, ahead of this one.
+    bool Commit();
+
+    // Commit(), then wait until every record appended so far is on disk. Returns false on an I/O error.
+    bool Flush();
+
+    std::uint64_t NextSequence() const { return next_; }  // sequence the next appended record gets
+    std::uint64_t CommittedSequence() const { return committed_.load(std::memory_order_acquire); }  // every record before it is on disk
+
+    // Wait until every record before `sequence` is on disk; they must have been committed already (Commit()).
+    // Returns false on an I/O error.
+    bool WaitCommitted(std::uint64_t sequence);
+
+    // Hand every committed record from the given sequence onwards to `apply`, in order. Returns the number replayed.
+    std::size_t Replay(std::uint64_t fromSequence, const std::function<void(const OrderCommand&)>& apply) const;
+
+private:
+    using Batch = std::vector<JournalRecord>;
+
+    Journal(int fd, const JournalConfig& config, std::uint64_t records);
+
+    void Write();  // body of the writer thread
+    bool WriteBatch(const Batch& batch);  // write (and sync) one batch; on an error the file is put back as it was
+
+    int fd_;
+    std::size_t groupCommit_;
+    bool sync_;
+
+    // owner's side
+    std::uint64_t next_;
+    Batch buffer_;
+    Timestamp batchTime_{};
+
+    // owner -> writer thread: full batches in journal order, and emptied ones coming back -> a warm journal does not allocate.
+    std::mutex mutex_;
+    std::condition_variable writerWakeUp_;
+    std::condition_variable flushed_;  // a batch was written, or failed
+    std::deque<Batch> pending_;
+    std::vector<Batch> spare_;
+    bool failed_{ false };  // the front of pending_ could not be written, waiting for the next Commit() to retry
+    bool stop_{ false };
+
+    std::atomic<std::uint64_t> committed_;  // written by the writer thread only
+    std::thread writer_;  // last: started once everything above is constructed
+};
+
+/*
+ * Read-only mapping of a journal file, e.g., a captured trading day fed to the replay tool.
+ * Unlike Journal::Open(), it never modifies the file: a torn tail is simply left out of Records().
+ */
+class JournalView{
+public:
+    static std::unique_ptr<JournalView> Open(const std::string& path);  // nullptr if the file cannot be mapped
+
+    JournalView(const JournalView&) = delete;
+    void operator=(const JournalView&) = delete;
+
+    ~JournalView();
+
+    std::span<const JournalRecord> Records() const { return { records_, count_ }; }
+
+private:
+    JournalView(void* mapping, std::size_t bytes, std::size_t count);
+
+    void* mapping_;
+    std::size_t bytes_;
+    const JournalRecord* records_;
+    std::size_t count_;
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include <algorithm> // for std::min, std::max
+#include <array>
+#include <bit>  // for std::bit_width
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/*
+ * Fixed-size log-linear histogram of latencies in nanoseconds (HdrHistogram-style):
+ * every power of two is split into 32 linear buckets, so a recorded value is known to within ~3%,
+ * whatever its magnitude. Recording is a couple of shifts and an increment, it never allocates.
+ */
+class LatencyHistogram{
+public:
+    void Record(std::uint64_t nanoseconds){
+        ++buckets_[Index(nanoseconds)];
+        ++count_;
+        total_ += nanoseconds;
+        min_ = std::min(min_, nanoseconds);
+        max_ = std::max(max_, nanoseconds);
+    }
+
+    void Merge(const LatencyHistogram& other){
+        for (std::size_t i = 0; i < Buckets; ++i){
+            buckets_[i] += other.buckets_[i];
+        }
+        count_ += other.count_;
+        total_ += other.total_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    void Reset() { *this = LatencyHistogram{}; }
+
+    /*
+     * For values counted somewhere else (e.g., in atomic per-thread counters) and folded in later:
+     * `count` values known to fall into `bucket`. Min, max and mean then come from the bucket bounds, i.e., within ~3%.
+     */
+    static constexpr std::size_t BucketCount() { return Buckets; }
+    static std::size_t BucketOf(std::uint64_t nanoseconds) { return Index(nanoseconds); }
+
+    void AddToBucket(std::size_t bucket, std::uint64_t count){
+        if (count == 0) return;
+        const std::uint64_t value = UpperBound(bucket);
+        buckets_[bucket] += count;
+        count_ += count;
+        total_ += value * count;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    std::uint64_t Count() const { return count_; }
+    std::uint64_t Min() const { return count_ ? min_ : 0; }
+    std::uint64_t Max() const { return max_; }
+    double Mean() const { return count_ ? static_cast<double>(total_) / static_cast<double>(count_) : 0.0; }
+
+    // Upper bound of the bucket holding the given fraction (0.99 -> p99) of the recorded values.
+    std::uint64_t Percentile(double fraction) const {
+        if (count_ == 0) return 0;
+
+        const auto rank = static_cast<std::uint64_t>(fraction * static_cast<double>(count_ - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < Buckets; ++i){
+            seen += buckets_[i];
+            if (seen >= rank) return std::min(UpperBound(i), max_);
+        }
+        return max_;
+    }
+
+private:
+    static constexpr unsigned SubBucketBits = 5;
+    static constexpr std::uint64_t SubBuckets = std::uint64_t{ 1 } << SubBucketBits;  // 32 per power of two
+    static constexpr std::size_t Buckets = SubBuckets * (64 - SubBucketBits + 1);  // 64 exact values, then 32 per shift 1..58
+
+    // values below 2 * SubBuckets map 1:1, above that: the top SubBucketBits + 1 bits of the value.
+    static std::size_t Index(std::uint64_t value){
+        const unsigned width = static_cast<unsigned>(std::bit_width(value));
+        if (width <= SubBucketBits + 1) return static_cast<std::size_t>(value);
+
+        const unsigned shift = width - (SubBucketBits + 1);
+        return static_cast<std::size_t>(SubBuckets * shift + (value >> shift));
+    }
+
+    static std::uint64_t UpperBound(std::size_t index){
+        if (index < 2 * SubBuckets) return index;
+
+        const std::uint64_t shift = index / SubBuckets - 1;
+        const std::uint64_t mantissa = index - SubBuckets * shift;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    std::array<std::uint64_t, Buckets> buckets_{};
+    std::uint64_t count_{};
+    std::uint64_t total_{};
+    std::uint64_t min_{ std::numeric_limits<std::uint64_t>::max() };
+    std::uint64_t max_{};
+};
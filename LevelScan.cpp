@@ -0,0 +1,96 @@
+#include "LevelScan.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define ORDERBOOK_LEVELSCAN_AVX2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ORDERBOOK_LEVELSCAN_NEON 1
+#endif
+
+namespace {
+    using Kernel = std::uint64_t (*)(const Quantity*, std::size_t, std::uint64_t, std::size_t&);
+
+    // from `start`, level by level -> the tail, and the block where the target is crossed.
+    std::uint64_t Finish(const Quantity* quantities, std::size_t start, std::size_t count, std::uint64_t sum, std::uint64_t target, std::size_t& levels){
+        std::size_t i = start;
+        while (i < count && sum < target){
+            sum += quantities[i++];
+        }
+        levels = i;
+        return sum;
+    }
+
+    std::uint64_t SumUntilScalar(const Quantity* quantities, std::size_t count, std::uint64_t target, std::size_t& levels){
+        return Finish(quantities, 0, count, 0, target, levels);
+    }
+
+#if ORDERBOOK_LEVELSCAN_AVX2
+    // ! compiled for AVX2 on its own, the rest of the build stays baseline x86-64 -> only called once the CPU is known to have it.
+    __attribute__((target("avx2")))
+    std::uint64_t SumUntilAvx2(const Quantity* quantities, std::size_t count, std::uint64_t target, std::size_t& levels){
+        constexpr std::size_t Block = 8;  // levels per iteration: 8 x 32 bits, summed as 2 x 4 x 64 bits (no overflow)
+
+        std::uint64_t sum = 0;
+        std::size_t i = 0;
+        for (; i + Block <= count; i += Block){
+            const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(quantities + i));
+            const __m256i low = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(values));
+            const __m256i high = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(values, 1));
+            const __m256i pairs = _mm256_add_epi64(low, high);
+            const __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1));
+            const std::uint64_t block = static_cast<std::uint64_t>(_mm_cvtsi128_si64(halves)) + static_cast<std::uint64_t>(_mm_extract_epi64(halves, 1));
+
+            if (sum + block >= target) break;  // the target is crossed inside this block
+            sum += block;
+        }
+        return Finish(quantities, i, count, sum, target, levels);
+    }
+#endif
+
+#if ORDERBOOK_LEVELSCAN_NEON
+    std::uint64_t SumUntilNeon(const Quantity* quantities, std::size_t count, std::uint64_t target, std::size_t& levels){
+        constexpr std::size_t Block = 8;  // 2 x 4 x 32 bits, widened to 64 bits while being added pairwise
+
+        std::uint64_t sum = 0;
+        std::size_t i = 0;
+        for (; i + Block <= count; i += Block){
+            const uint64x2_t low = vpaddlq_u32(vld1q_u32(quantities + i));
+            const uint64x2_t high = vpaddlq_u32(vld1q_u32(quantities + i + 4));
+            const std::uint64_t block = vaddvq_u64(vaddq_u64(low, high));
+
+            if (sum + block >= target) break;
+            sum += block;
+        }
+        return Finish(quantities, i, count, sum, target, levels);
+    }
+#endif
+
+    struct Selected{
+        Kernel kernel_;
+        const char* name_;
+    };
+
+    Selected Select(){
+#if ORDERBOOK_LEVELSCAN_AVX2
+        if (__builtin_cpu_supports("avx2")) return { SumUntilAvx2, "avx2" };
+#elif ORDERBOOK_LEVELSCAN_NEON
+        return { SumUntilNeon, "neon" };
+#endif
+        return { SumUntilScalar, "scalar" };
+    }
+
+    // once, on first use -> every later call is a plain indirect call.
+    const Selected& Chosen(){
+        static const Selected selected = Select();
+        return selected;
+    }
+}
+
+namespace LevelScan{
+    std::uint64_t SumUntil(const Quantity* quantities, std::size_t count, std::uint64_t target, std::size_t& levels){
+        return Chosen().kernel_(quantities, count, target, levels);
+    }
+
+    const char* Kernel() { return Chosen().name_; }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Types.h"
+
+/*
+ * Scans over a dense array of per-level quantities (PriceLadder keeps one for its window), best level first.
+ *
+ * Vectorised where the CPU allows (AVX2 on x86-64, picked at runtime; NEON on AArch64), scalar otherwise.
+ * Whole blocks of levels that cannot reach the target are added up in a few vector instructions,
+ * only the block where the target is crossed is walked level by level.
+ */
+namespace LevelScan{
+    /*
+     * Add up quantities[0], quantities[1], ... until the sum reaches `target`.
+     * Returns the sum of the first `levels` quantities, where `levels` is the fewest that reach the target
+     * (count if even all of them do not) -> the quantity behind quantities[levels - 1] is the level covering it.
+     */
+    std::uint64_t SumUntil(const Quantity* quantities, std::size_t count, std::uint64_t target, std::size_t& levels);
+
+    // Name of the kernel SumUntil() runs on this machine: "avx2", "neon" or "scalar".
+    const char* Kernel();
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+#include "Types.h"
+
+enum class MarketDataType : std::uint8_t{
+    AddLevel,  // a new price level appeared
+    ChangeLevel,  // the quantity (and/or order count) of an existing level changed
+    DeleteLevel,  // the last order of the level is gone
+    Trade,  // a fill: side_ is the aggressor, price_ the price of the resting order
+};
+
+/*
+ * One incremental market-data update, in a fixed binary layout: 32 bytes, no padding left to the compiler,
+ * so a consumer in another process (or written in another language) can read it straight out of the ring.
+ *
+ * Levels report their state after the update, so a consumer never has to apply deltas:
+    * quantity_ -> total quantity resting at the level
+    * orders_ -> number of orders resting at the level
+ * Trades report the traded quantity, and orders_ is 0.
+ */
+struct MarketDataMessage{
+    std::uint64_t sequence_{};  // stamped by the ring, gap-free per ring
+    SymbolId symbol_{};
+    MarketDataType type_{ MarketDataType::ChangeLevel };
+    std::uint8_t side_{};  // Side, narrowed to a byte for the wire: 0 = Buy, 1 = Sell
+    std::uint16_t reserved_{};
+    Price price_{};
+    Quantity quantity_{};
+    std::uint32_t orders_{};
+    std::uint32_t reserved2_{};
+
+    static MarketDataMessage Level(SymbolId symbol, MarketDataType type, Side side, Price price, Quantity quantity, std::uint32_t orders){
+        MarketDataMessage message;
+        message.symbol_ = symbol;
+        message.type_ = type;
+        message.side_ = static_cast<std::uint8_t>(side);
+        message.price_ = price;
+        message.quantity_ = quantity;
+        message.orders_ = orders;
+        return message;
+    }
+
+    static MarketDataMessage TradePrint(SymbolId symbol, Side aggressor, Price price, Quantity quantity){
+        return Level(symbol, MarketDataType::Trade, aggressor, price, quantity, 0);
+    }
+};
+
+static_assert(sizeof(MarketDataMessage) == 32);
+static_assert(std::is_trivially_copyable_v<MarketDataMessage>);
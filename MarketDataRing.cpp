@@ -0,0 +1,142 @@
+#include <bit>  // for std::bit_ceil
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MarketDataRing.h"
+
+std::unique_ptr<MarketDataRing> MarketDataRing::Create(const std::string& name, std::size_t capacity){
+    capacity = std::bit_ceil(capacity < 2 ? std::size_t{ 2 } : capacity);  // power of two -> the slot of a sequence is a mask away.
+    const std::size_t bytes = SegmentBytes(capacity);
+
+    void* mapping = MAP_FAILED;
+    if (name.empty()){
+        mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    } else {
+        const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (fd < 0) return nullptr;
+
+        if (ftruncate(fd, static_cast<off_t>(bytes)) == 0){
+            mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);  // the mapping keeps the segment alive
+
+        if (mapping == MAP_FAILED){
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+    }
+    if (mapping == MAP_FAILED) return nullptr;
+
+    // ftruncate / MAP_ANONYMOUS hand out zeroed pages -> every slot starts out as "sequence 0, not published".
+    auto* header = new (mapping) Header{ 0, capacity, {} };
+    header->published_.store(0, std::memory_order_relaxed);
+    header->magic_ = Magic;  // last: a consumer opening the segment concurrently rejects it until it is set up
+
+    return std::unique_ptr<MarketDataRing>{ new MarketDataRing{ name, mapping, bytes, true } };
+}
+
+std::unique_ptr<MarketDataRing> MarketDataRing::Open(const std::string& name){
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return nullptr;
+
+    struct stat info{};
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(Header)){
+        mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) return nullptr;
+
+    const auto bytes = static_cast<std::size_t>(info.st_size);
+    const auto* header = static_cast<const Header*>(mapping);
+    if (
+        header->magic_ != Magic ||
+        !std::has_single_bit(header->capacity_) ||
+        SegmentBytes(header->capacity_) > bytes
+    ){
+        munmap(mapping, bytes);
+        return nullptr;
+    }
+
+    return std::unique_ptr<MarketDataRing>{ new MarketDataRing{ name, mapping, bytes, false } };
+}
+
+MarketDataRing::MarketDataRing(std::string name, void* mapping, std::size_t bytes, bool owner)
+    : name_{ std::move(name) }
+    , mapping_{ mapping }
+    , bytes_{ bytes }
+    , owner_{ owner }
+    , header_{ static_cast<Header*>(mapping) }
+    , slots_{ reinterpret_cast<Slot*>(static_cast<char*>(mapping) + sizeof(Header)) }
+    , mask_{ static_cast<std::size_t>(header_->capacity_) - 1 }
+    , next_{ header_->published_.load(std::memory_order_relaxed) }
+{}
+
+MarketDataRing::~MarketDataRing(){
+    munmap(mapping_, bytes_);
+    if (owner_ && !name_.empty()){
+        shm_unlink(name_.c_str());
+    }
+}
+
+MarketDataRing::ReadResult MarketDataRing::Read(std::uint64_t sequence, MarketDataMessage& message) const {
+    const std::uint64_t published = Published();
+    if (sequence >= published) return ReadResult::NotYet;
+    if (published - sequence > Capacity()) return ReadResult::Overrun;
+
+    // ! the consumer mapping is read-only -> only ever load through the atomic_ref, never store.
+    auto& slot = slots_[sequence & mask_];
+    std::atomic_ref<std::uint64_t> version{ slot.sequence_ };
+
+    if (version.load(std::memory_order_acquire) != sequence) return ReadResult::Overrun;  // being rewritten for sequence + capacity
+
+    std::uint64_t copy[PayloadWords + 1];
+    copy[0] = sequence;
+    for (std::size_t i = 0; i < PayloadWords; ++i){
+        copy[i + 1] = std::atomic_ref<std::uint64_t>{ slot.payload_[i] }.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);  // the copy is done before the version is looked at again
+    if (version.load(std::memory_order_relaxed) != sequence) return ReadResult::Overrun;  // torn: the publisher got there meanwhile
+
+    std::memcpy(&message, copy, sizeof(message));
+    return ReadResult::Ok;
+}
+
+MarketDataReader::MarketDataReader(const MarketDataRing& ring, bool fromOldest)
+    : ring_{ ring }
+    , next_{ ring.Published() }
+{
+    if (fromOldest){
+        next_ = next_ > ring.Capacity() ? next_ - ring.Capacity() : 0;
+    }
+}
+
+bool MarketDataReader::Poll(MarketDataMessage& message){
+    while (true){
+        switch (ring_.Read(next_, message)){
+            case MarketDataRing::ReadResult::Ok:
+                ++next_;
+                return true;
+            case MarketDataRing::ReadResult::NotYet:
+                return false;
+            case MarketDataRing::ReadResult::Overrun: {
+                // lapped -> jump to the oldest message that is still there, and account for the ones in between.
+                const std::uint64_t published = ring_.Published();
+                const std::uint64_t oldest = published > ring_.Capacity() ? published - ring_.Capacity() + 1 : 0;
+                if (oldest > next_){
+                    dropped_ += oldest - next_;
+                    next_ = oldest;
+                } else {
+                    // the slot is mid-rewrite but the header is older: the message is gone either way.
+                    ++dropped_;
+                    ++next_;
+                }
+                break;
+            }
+        }
+    }
+}
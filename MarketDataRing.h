@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <cstddef>  // for offsetof
+#include <cstdint>
+#include <cstring>  // for std::memcpy
+#include <memory>
+#include <string>
+
+#include "MarketData.h"
+
+/*
+ * Broadcast ring of MarketDataMessage, laid out in a POSIX shared-memory segment:
+    * [ Header (one cache line) | capacity slots of 32 bytes ]
+ * One publisher (the book) writes, any number of consumer processes map the same segment read-only
+ * and read the messages in place. Consumers never hold the publisher back: one that falls more than
+ * a ring behind sees an overrun (and the sequence it can resume from) instead.
+ *
+ * Each slot carries its own sequence_, used as a per-slot seqlock: the publisher marks the slot
+ * as being written, fills it, then stamps the sequence -> a reader can tell a torn read from a good one.
+ * As in SeqLock.h, the rest of the slot is copied word by word through relaxed atomics -> a torn read is detected
+ * and retried, never undefined behaviour.
+ */
+class MarketDataRing{
+public:
+    // Create (or truncate) the segment and map it read-write, as the publisher.
+    // The segment is unlinked again when the publisher is destroyed. An empty name maps private memory instead (in-process use).
+    // Returns nullptr if the segment cannot be created or mapped.
+    static std::unique_ptr<MarketDataRing> Create(const std::string& name, std::size_t capacity);
+
+    // Map an existing segment read-only, as a consumer. Returns nullptr if it does not exist or is not a ring.
+    static std::unique_ptr<MarketDataRing> Open(const std::string& name);
+
+    MarketDataRing(const MarketDataRing&) = delete;
+    void operator=(const MarketDataRing&) = delete;
+
+    ~MarketDataRing();
+
+    // Publisher side: stamp the next sequence number on the message and write it. Single publisher only.
+    void Publish(MarketDataMessage message){
+        const std::uint64_t sequence = next_++;
+        auto& slot = slots_[sequence & mask_];
+        std::atomic_ref<std::uint64_t> version{ slot.sequence_ };
+
+        message.reserved_ = 0;
+        message.reserved2_ = 0;
+        std::uint64_t source[PayloadWords + 1];
+        std::memcpy(source, &message, sizeof(message));  // source[0] is the sequence_ field, stamped through `version` instead
+
+        version.store(Writing, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);  // nobody sees the new words before the Writing mark
+
+        for (std::size_t i = 0; i < PayloadWords; ++i){
+            std::atomic_ref<std::uint64_t>{ slot.payload_[i] }.store(source[i + 1], std::memory_order_relaxed);
+        }
+
+        version.store(sequence, std::memory_order_release);
+        header_->published_.store(sequence + 1, std::memory_order_release);
+    }
+
+    enum class ReadResult{
+        Ok,
+        NotYet,  // nothing published with that sequence yet
+        Overrun,  // the slot has been reused since -> the message is lost, resume from Published() - Capacity()
+    };
+
+    // Consumer side: copy the message with the given sequence out of the ring.
+    ReadResult Read(std::uint64_t sequence, MarketDataMessage& message) const;
+
+    std::uint64_t Published() const { return header_->published_.load(std::memory_order_acquire); }
+    std::size_t Capacity() const { return mask_ + 1; }
+
+private:
+    static constexpr std::uint64_t Magic = 0x4d44524e47303031;  // "MDRNG001"
+    static constexpr std::uint64_t Writing = static_cast<std::uint64_t>(-1);
+
+    struct alignas(64) Header{
+        std::uint64_t magic_;
+        std::uint64_t capacity_;
+        std::atomic<std::uint64_t> published_;  // sequence of the next message to be published
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the sequence is shared across processes");
+
+    // A MarketDataMessage as it sits in the ring: same bytes, seen as the sequence word and the words after it.
+    static constexpr std::size_t PayloadWords = sizeof(MarketDataMessage) / sizeof(std::uint64_t) - 1;
+    struct Slot{
+        std::uint64_t sequence_;
+        std::uint64_t payload_[PayloadWords];
+    };
+    static_assert(sizeof(Slot) == sizeof(MarketDataMessage) && offsetof(MarketDataMessage, sequence_) == 0);
+
+    MarketDataRing(std::string name, void* mapping, std::size_t bytes, bool owner);
+
+    static std::size_t SegmentBytes(std::size_t capacity) { return sizeof(Header) + capacity * sizeof(Slot); }
+
+    std::string name_;
+    void* mapping_;
+    std::size_t bytes_;
+    bool owner_;  // the publisher unlinks the segment on destruction
+
+    Header* header_;
+    Slot* slots_;
+    std::size_t mask_;
+    std::uint64_t next_{};  // publisher only
+};
+
+/*
+ * Consumer cursor over a ring: hand out the messages one by one, in sequence,
+ * and skip ahead (counting what was lost) when the publisher has lapped it.
+ */
+class MarketDataReader{
+public:
+    // Start from the oldest message still in the ring, or only from the ones published after now.
+    explicit MarketDataReader(const MarketDataRing& ring, bool fromOldest = false);
+
+    // Take the next message, false if there is nothing new.
+    bool Poll(MarketDataMessage& message);
+
+    std::uint64_t Next() const { return next_; }
+    std::uint64_t Dropped() const { return dropped_; }
+
+private:
+    const MarketDataRing& ring_;
+    std::uint64_t next_;
+    std::uint64_t dropped_{};
+};
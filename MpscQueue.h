@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <bit>  // for std::bit_ceil
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/*
+ * Bounded multi-producer / single-consumer queue (Vyukov's sequence-stamped ring).
+ *
+ * Any number of threads may call TryPush(); exactly one thread may call TryPop().
+ * Each cell carries a sequence number telling whether it is free for the producer holding a given position,
+ * or filled for the consumer -> producers only contend on one CAS of enqueuePos_, and nothing ever blocks.
+ */
+template <typename T>
+class MpscQueue{
+public:
+    explicit MpscQueue(std::size_t capacity)
+        : capacity_{ std::bit_ceil(capacity < 2 ? std::size_t{ 2 } : capacity) }
+        , mask_{ capacity_ - 1 }
+        , cells_{ std::make_unique<Cell[]>(capacity_) }
+    {
+        for (std::size_t i = 0; i < capacity_; ++i){
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    void operator=(const MpscQueue&) = delete;
+
+    // Producer side, thread-safe. Returns false if the queue is full.
+    bool TryPush(const T& value){
+        std::size_t position = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        while (true){
+            cell = &cells_[position & mask_];
+            const std::size_t sequence = cell->sequence_.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+            if (difference == 0){
+                // the cell is free for this position -> try to claim it
+                if (enqueuePos_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0){
+                return false;  // the consumer has not freed this cell yet -> full
+            } else {
+                position = enqueuePos_.load(std::memory_order_relaxed);  // another producer got it first
+            }
+        }
+
+        cell->value_ = value;
+        cell->sequence_.store(position + 1, std::memory_order_release);  // publish to the consumer
+        return true;
+    }
+
+    // Consumer side, single thread only. Returns false if the queue is empty.
+    bool TryPop(T& value){
+        Cell& cell = cells_[dequeuePos_ & mask_];
+        const std::size_t sequence = cell.sequence_.load(std::memory_order_acquire);
+
+        if (static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(dequeuePos_ + 1) < 0){
+            return false;  // not published yet
+        }
+
+        value = cell.value_;
+        cell.sequence_.store(dequeuePos_ + capacity_, std::memory_order_release);  // free it for the next lap
+        ++dequeuePos_;
+        return true;
+    }
+
+    std::size_t capacity() const { return capacity_; }
+
+private:
+    static constexpr std::size_t CacheLine = 64;
+
+    struct Cell{
+        std::atomic<std::size_t> sequence_{ 0 };
+        T value_{};
+    };
+
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    const std::unique_ptr<Cell[]> cells_;
+
+    alignas(CacheLine) std::atomic<std::size_t> enqueuePos_{ 0 };
+    alignas(CacheLine) std::size_t dequeuePos_{ 0 };  // only the consumer touches it
+};
@@ -1,5 +1,3 @@
-#include <format>
-
 #include "Order.h"
 
 Order::Order(OrderType orderType, OrderId orderId, Side side, Price price, Quantity quantity)
@@ -15,31 +13,60 @@ Order::Order(OrderId orderId, Side side, Quantity quantity)
     : Order::Order(OrderType::Market, orderId, side, Constants::InvalidPrice, quantity)
 {}
 
-void Order::Fill(Quantity quantity){
+Order::Order(OrderId orderId, Side side, Price price, Quantity quantity, Timestamp expiry)
+    : Order::Order(OrderType::GoodTillDate, orderId, side, price, quantity)
+{
+    expiry_ = expiry;
+}
+
+bool Order::Fill(Quantity quantity){
     /*
     * Fill the quantity of Order with the given quantity
     */
     // The lowest quantity between both orders is the quantity used to fill the order.
     // i.e., float quantityToBeFilled = std::min(quantityToSell, quantityToBuy);
+    // An order cannot be filled for more than its remaining quantity.
     if (quantity > GetRemainingQuantity()){
-        throw std::logic_error(std::format(
-            "Order ({}) cannot be filled for more than its remaining quantity.", GetOrderId()
-        ));
+        return false;
     }
 
     remainingQuantity_ -= quantity;
+    return true;
+}
+
+void Order::Amend(Side side, Price price, Quantity quantity){
+    initialQuantity_ = GetFilledQuantity() + quantity;
+    remainingQuantity_ = quantity;
+    side_ = side;
+    price_ = price;
 }
 
-void Order::ToGoodTillCancel(Price price){
+bool Order::ToGoodTillCancel(Price price){
     /*
      * change the type of order to GTC (why?)
      * Market to GTC
      */
+    // only market orders can have their price adjusted.
     if (GetOrderType() != OrderType::Market)
-        throw std::logic_error(std::format(
-            "Order ({}) cannot have have its price adjusted, only market orders can.", GetOrderId()
-        ));
+        return false;
 
     price_ = price;
     orderType_ = OrderType::GoodTillCancel;
+    return true;
+}
+
+bool Order::Trigger(){
+    /*
+     * the stop price has been traded through -> the order goes in as what it was waiting to be.
+     * Stop to Market (its price is not looked at), StopLimit to GTC at its limit price.
+     */
+    if (GetOrderType() == OrderType::Stop){
+        orderType_ = OrderType::Market;
+        return true;
+    }
+    if (GetOrderType() == OrderType::StopLimit){
+        orderType_ = OrderType::GoodTillCancel;
+        return true;
+    }
+    return false;
 }
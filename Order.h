@@ -1,9 +1,7 @@
 #pragma once
+#include <algorithm>  // for std::min
 #include <list>
-#include <exception>
-#include <string>
 #include <memory>
-#include <stdexcept>
 
 #include "Types.h"
 
@@ -13,6 +11,9 @@ public:
 
     Order(OrderId orderId, Side side, Quantity quantity);
 
+    // GoodTillDate order, resting until it is filled, cancelled or the expiry has passed.
+    Order(OrderId orderId, Side side, Price price, Quantity quantity, Timestamp expiry);
+
     OrderId GetOrderId() const { return orderId_; }
     OrderType GetOrderType() const { return orderType_; }
     Side GetSide() const { return side_; }
@@ -20,10 +21,27 @@ public:
     Quantity GetInitialQuantity() const { return initialQuantity_; }
     Quantity GetRemainingQuantity() const { return remainingQuantity_; }
     Quantity GetFilledQuantity() const { return GetInitialQuantity() - GetRemainingQuantity(); }
+    Timestamp GetExpiry() const { return expiry_; }  // NoExpiry unless GoodTillDate, or GoodForDay once it rests in a book
+    OwnerId GetOwner() const { return owner_; }
+    Price GetStopPrice() const { return stopPrice_; }  // Stop and StopLimit only, Constants::InvalidPrice otherwise
+
+    // Iceberg: only displayQuantity_ of it shows at a time, the rest is held in reserve. 0 -> fully displayed.
+    Quantity GetDisplayQuantity() const { return displayQuantity_; }
+    Quantity GetVisibleQuantity() const { return displayQuantity_ == 0 ? remainingQuantity_ : std::min(displayQuantity_, remainingQuantity_); }
+    Quantity GetHiddenQuantity() const { return GetRemainingQuantity() - GetVisibleQuantity(); }
 
-    void Fill(Quantity quantity);
+    // Both return false, leaving the order as it was, if the call does not apply to it (no exceptions on the order path).
+    bool Fill(Quantity quantity);  // false: more than the remaining quantity
     bool isFilled() const { return GetRemainingQuantity() == 0; }
-    void ToGoodTillCancel(Price price);
+    bool ToGoodTillCancel(Price price);  // false: not a market order
+    bool Trigger();  // Stop -> Market, StopLimit -> GoodTillCancel at its price. false: not a stop order
+    void SetExpiry(Timestamp expiry) { expiry_ = expiry; }
+    void SetOwner(OwnerId owner) { owner_ = owner; }  // e.g., the gateway session the order came in on
+    void SetStopPrice(Price stopPrice) { stopPrice_ = stopPrice; }
+    void SetDisplayQuantity(Quantity displayQuantity) { displayQuantity_ = displayQuantity; }
+
+    // Amend a resting order: the given quantity becomes its new open quantity, what has been filled stays filled.
+    void Amend(Side side, Price price, Quantity quantity);
 
 private:
     OrderId orderId_;
@@ -32,6 +50,10 @@ private:
     Price price_;
     Quantity initialQuantity_;
     Quantity remainingQuantity_;
+    Timestamp expiry_{ NoExpiry };
+    OwnerId owner_{ NoOwner };
+    Price stopPrice_{ Constants::InvalidPrice };
+    Quantity displayQuantity_{};
 };
 
 using OrderPointer = std::shared_ptr<Order>;
@@ -1,8 +1,16 @@
-#include <numeric> // for std::accumulate
 #include <algorithm> // for std::min
+#include <cerrno>
+#include <cstdio>
 #include <iterator>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "OrderBook.h"
+#include "ThreadAffinity.h"
 
 /*
  * Important information about Orders
@@ -16,42 +24,58 @@
     * Best Bid Offer (BBO)
  */
 
-bool OrderBook::CanMatch(Side side, Price price) const{
-    if (side == Side::Buy){  // BUY
-        if (asks_.empty()){
-            return false;
-        }
+template <Side S>
+auto& OrderBook::Levels(){
+    if constexpr (S == Side::Buy) return bids_;
+    else return asks_;
+}
+
+template <Side S>
+const auto& OrderBook::Levels() const {
+    if constexpr (S == Side::Buy) return bids_;
+    else return asks_;
+}
 
+template <Side S>
+bool OrderBook::CanMatch(Price price) const{
+    const auto& opposite = Levels<Opposite<S>>();
+    if (opposite.empty()){
+        return false;
+    }
+
+    if constexpr (S == Side::Buy){  // BUY
         // Get the best ask price
-        const auto& [bestAsk, _] = *asks_.begin();
         // if the price to buy is equal to or higher than the best sell price -> then we can sell
         /*
          * Someone wants to sell stock A at 100 USDT
          * Other person shows up and says he wants to buy the stock at 101
          * then that "someone" will be happy to sell.
          */
-        return price >= bestAsk;
+        return price >= opposite.BestPrice();
     } else {  // SELL
-        if (bids_.empty()){
-            return false;
-        }
-
         // Get the best bid price
-        const auto& [bestBid, _] = *bids_.begin();
         // if the price to sell is equal to or lower than the best buy price
         /*
          * A wants to buy a at 100 USDT
          * B shows up and says he can sell a at 99 USDT
          * A would be happy to buy (since he got it cheaper than his expectation)
          */
-        return price <= bestBid;
+        return price <= opposite.BestPrice();
     }
 }
 
-Trades OrderBook::MatchOrders(){
-    // Match the orders from bids and asks.
-    Trades trades;  // This should be an empty trades
-    trades.reserve(orders_.size());
+OrderResult OrderBook::MatchOrders(Side aggressor, TradeSink onTrade){
+    if (aggressor == Side::Buy){
+        return MatchOrders<Side::Buy>(onTrade);
+    }
+    return MatchOrders<Side::Sell>(onTrade);
+}
+
+template <Side Aggressor>
+OrderResult OrderBook::MatchOrders(TradeSink onTrade){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::Match };
+    // Match the orders from bids and asks, handing every fill to the sink as soon as it happens.
+    OrderResult result = OrderResult::Ok;
 
     while (true){
         // If either of them is empty, then we cannot proceed
@@ -60,10 +84,14 @@ Trades OrderBook::MatchOrders(){
         }
 
         // get the highest price to buy -> the best bid (the highest price to buy)
-        auto& [bidPrice, bids] = *bids_.begin();
+        const Price bidPrice = bids_.BestPrice();
+        auto& bidLevel = bids_.Best();
+        auto& bids = bidLevel.orders_;
 
         // get the lowest price to sell -> the best ask (the lowest price to sell)
-        auto& [askPrice, asks] = *asks_.begin();
+        const Price askPrice = asks_.BestPrice();
+        auto& askLevel = asks_.Best();
+        auto& asks = askLevel.orders_;
 
         if (bidPrice < askPrice){
             // there is nothing to match
@@ -71,56 +99,295 @@ Trades OrderBook::MatchOrders(){
         }
 
         while (bids.size() && asks.size()){
-            auto& bid = bids.front();
-            auto& ask = asks.front();
+            const OrderHandle bidHandle = orderPool_.Front(bids);
+            const OrderHandle askHandle = orderPool_.Front(asks);
+
+            // ! the book was not crossed before the aggressor came in -> it is the front of its side, the newest of the two.
+            if constexpr (Risk::PreventsSelfTrade){
+                if (PreventSelfTrade(Aggressor, bidLevel, bidHandle, askLevel, askHandle)){
+                    if constexpr (Risk::CancelsNewest) result = OrderResult::SelfTrade;
+                    continue;
+                }
+            }
+
+            // ! hot halves only: every order of a level rests at the level's price, the rest of the order is not needed here.
+            auto& bid = orderPool_.Hot(bidHandle);
+            auto& ask = orderPool_.Hot(askHandle);
+
+            Quantity quantity = std::min(bid.remainingQuantity_, ask.remainingQuantity_);
+
+            bid.remainingQuantity_ -= quantity;
+            ask.remainingQuantity_ -= quantity;
+            // an iceberg whose slice ran out is not done yet if it still holds some back.
+            const bool bidFilled = bid.remainingQuantity_ == 0 && !HasReserve(bidLevel, bidHandle);
+            const bool askFilled = ask.remainingQuantity_ == 0 && !HasReserve(askLevel, askHandle);
+
+            // report the trade before a filled order hands its slot back to the pool.
+            onTrade(
+                Trade{
+                    TradeInfo{ bid.orderId_, bidPrice, quantity },
+                    TradeInfo{ ask.orderId_, askPrice, quantity }
+                }
+            );
 
-            Quantity quantity = std::min(bid->GetRemainingQuantity(), ask->GetRemainingQuantity());
+            // printed at the price of the order that was resting, i.e., the one on the other side of the aggressor.
+            const Price printPrice = Aggressor == Side::Buy ? askPrice : bidPrice;
+            NotePrint(printPrice);
+            if (marketData_){
+                marketData_->Publish(MarketDataMessage::TradePrint(symbol_, Aggressor, printPrice, quantity));
+            }
+
+            OnOrderMatched(bidLevel, Side::Buy, bidPrice, quantity, bidFilled);
+            OnOrderMatched(askLevel, Side::Sell, askPrice, quantity, askFilled);
 
-            bid->Fill(quantity);
-            ask->Fill(quantity);
+            if (bidFilled){
+                orderPool_.Erase(bids, bidHandle);
+                orders_.Erase(bid.orderId_);
+                ForgetOwner(bidHandle);
+                orderPool_.Release(bidHandle);
+            } else if (bid.remainingQuantity_ == 0){
+                Replenish(bidLevel, Side::Buy, bidPrice, bidHandle);
+            }
 
-            if (bid->isFilled()){
-                bids.pop_front();
-                orders_.erase(bid->GetOrderId());
+            if (askFilled){
+                orderPool_.Erase(asks, askHandle);
+                orders_.Erase(ask.orderId_);
+                ForgetOwner(askHandle);
+                orderPool_.Release(askHandle);
+            } else if (ask.remainingQuantity_ == 0){
+                Replenish(askLevel, Side::Sell, askPrice, askHandle);
             }
+        }
+
+        // erase the exhausted level only after we are done with the references into it.
+        if (bids.empty()){
+            bids_.Erase(bidPrice);
+        }
+
+        if (asks.empty()){
+            asks_.Erase(askPrice);
+        }
+    }
+    return result;
+}
+
+template <Side Aggressor, OrderType T>
+OrderResult OrderBook::SweepOrders(const Order& order, TradeSink onTrade){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::Match };
+    /*
+     * Same matching as MatchOrders(), except that the aggressor is never linked into a level (nor indexed in orders_):
+     * it is walked against the opposite side straight out of the incoming order, and whatever is left of it at the end is simply dropped.
+     * -> no level insert/erase, no pool slot and no cancel for the remainder, and no level updates on the aggressor's side of the feed.
+     *
+     * Market: no limit, every level on the other side is fair game, and its fills report the price it got (the resting level's).
+     * Otherwise: stops at the first level beyond the order's limit price, its fills report that limit (as a resting order at it would).
+     */
+    constexpr Side RestingSide = Opposite<Aggressor>;
+    auto& opposite = Levels<RestingSide>();
+    Quantity remaining = order.GetInitialQuantity();
+    bool cancelled = false;  // by self-trade prevention
+
+    while (remaining > 0 && !cancelled && !opposite.empty()){
+        if constexpr (T != OrderType::Market){
+            if (!CanMatch<Aggressor>(order.GetPrice())) break;
+        }
+
+        const Price levelPrice = opposite.BestPrice();
+        const Price aggressorPrice = T == OrderType::Market ? levelPrice : order.GetPrice();
+        auto& level = opposite.Best();
+        auto& orders = level.orders_;
+
+        while (remaining > 0 && orders.size()){
+            const OrderHandle handle = orderPool_.Front(orders);
+
+            // the aggressor has no pool slot: its owner comes straight off the incoming order.
+            if constexpr (Risk::PreventsSelfTrade){
+                if (order.GetOwner() != NoOwner && orderPool_.Ownership(handle).owner_ == order.GetOwner()){
+                    if constexpr (Risk::CancelsOldest) CancelAtLevel(level, handle);
+                    if constexpr (Risk::CancelsNewest){
+                        cancelled = true;
+                        break;
+                    }
+                    continue;
+                }
+            }
+
+            auto& resting = orderPool_.Hot(handle);
 
-            if (ask->isFilled()){
-                asks.pop_front();
-                orders_.erase(ask->GetOrderId());
+            const Quantity quantity = std::min(remaining, resting.remainingQuantity_);
+            remaining -= quantity;
+            resting.remainingQuantity_ -= quantity;
+            const bool filled = resting.remainingQuantity_ == 0 && !HasReserve(level, handle);
+
+            const TradeInfo aggressorFill{ order.GetOrderId(), aggressorPrice, quantity };
+            const TradeInfo restingFill{ resting.orderId_, levelPrice, quantity };
+            onTrade(Aggressor == Side::Buy ? Trade{ aggressorFill, restingFill } : Trade{ restingFill, aggressorFill });
+
+            NotePrint(levelPrice);
+            if (marketData_){
+                marketData_->Publish(MarketDataMessage::TradePrint(symbol_, Aggressor, levelPrice, quantity));
             }
 
-            if (bids.empty()){
-                bids_.erase(bidPrice);
+            OnOrderMatched(level, RestingSide, levelPrice, quantity, filled);
+
+            if (filled){
+                orderPool_.Erase(orders, handle);
+                orders_.Erase(resting.orderId_);
+                ForgetOwner(handle);
+                orderPool_.Release(handle);
+            } else if (resting.remainingQuantity_ == 0){
+                Replenish(level, RestingSide, levelPrice, handle);
             }
+        }
+
+        if (orders.empty()){
+            opposite.Erase(levelPrice);
+        }
+    }
+
+    if (cancelled) return OrderResult::SelfTrade;
+    return remaining < order.GetInitialQuantity() ? OrderResult::Ok : OrderResult::NotExecuted;
+}
+
+AuctionInfo OrderBook::ComputeUncross() const {
+    AuctionInfo best;
+    if (bids_.empty() || asks_.empty() || bids_.BestPrice() < asks_.BestPrice()){
+        return best;
+    }
+
+    // only the levels within [best ask, best bid] can trade, and the equilibrium is at the price of one of them.
+    const Price highest = bids_.BestPrice();
+    const Price lowest = asks_.BestPrice();
+    auctionBids_.clear();
+    auctionAsks_.clear();
+
+    std::uint64_t demand = 0;  // bids at the candidate price or better
+    bids_.ForEach([&](Price price, const PriceLevel& level){
+        if (price < lowest) return false;
+        auctionBids_.push_back(AuctionLevel{ price, AuctionQuantity(level) });
+        demand += auctionBids_.back().quantity_;
+        return true;
+    });
+    asks_.ForEach([&](Price price, const PriceLevel& level){
+        if (price > highest) return false;
+        auctionAsks_.push_back(AuctionLevel{ price, AuctionQuantity(level) });
+        return true;
+    });
+
+    /*
+     * One pass over the candidates in ascending price, merging both buffers: the asks from their front (best first),
+     * the bids from their back (worst first) -> the supply only grows along the way, and the demand only shrinks.
+     */
+    std::uint64_t supply = 0;  // asks at the candidate price or better
+    auto bid = auctionBids_.rbegin();
+    auto ask = auctionAsks_.begin();
+    while (bid != auctionBids_.rend() || ask != auctionAsks_.end()){
+        const Price price =
+            bid == auctionBids_.rend() ? ask->price_ :
+            ask == auctionAsks_.end() ? bid->price_ :
+            std::min(bid->price_, ask->price_);
+
+        if (ask != auctionAsks_.end() && ask->price_ == price){
+            supply += (ask++)->quantity_;
+        }
+
+        const std::uint64_t volume = std::min(demand, supply);
+        const std::uint64_t surplus = demand > supply ? demand - supply : supply - demand;
+        // most volume, then least surplus; a tie on both moves up only for a buy surplus (the buyers would pay more).
+        if (
+            volume > best.volume_ ||
+            (volume == best.volume_ && (surplus < best.surplus_ || (surplus == best.surplus_ && demand > supply)))
+        ){
+            best = AuctionInfo{ price, volume, surplus, demand > supply ? Side::Buy : Side::Sell };
+        }
+
+        // the bids at this price still count for this price, not for the next one up.
+        if (bid != auctionBids_.rend() && bid->price_ == price){
+            demand -= (bid++)->quantity_;
+        }
+    }
+    return best;
+}
+
+void OrderBook::UncrossOrders(const AuctionInfo& uncross, TradeSink onTrade){
+    /*
+     * MatchOrders(), with every fill at the equilibrium price instead of the resting order's, and only for as long as
+     * both best levels are on the right side of it. Price-time priority as usual: the best levels first, the front of each first.
+     * ! At the price of the most volume, whichever side runs out first takes everything crossing on its side with it
+     * ! -> what is left does not cross any more.
+     */
+    const Price price = uncross.price_;
+
+    while (!bids_.empty() && !asks_.empty() && bids_.BestPrice() >= price && asks_.BestPrice() <= price){
+        const Price bidPrice = bids_.BestPrice();
+        auto& bidLevel = bids_.Best();
+        auto& bids = bidLevel.orders_;
+
+        const Price askPrice = asks_.BestPrice();
+        auto& askLevel = asks_.Best();
+        auto& asks = askLevel.orders_;
 
-            if (asks.empty()){
-                asks_.erase(askPrice);
+        while (bids.size() && asks.size()){
+            const OrderHandle bidHandle = orderPool_.Front(bids);
+            const OrderHandle askHandle = orderPool_.Front(asks);
+
+            if constexpr (Risk::PreventsSelfTrade){
+                if (PreventSelfTrade(uncross.surplusSide_, bidLevel, bidHandle, askLevel, askHandle)) continue;
             }
 
-            trades.push_back(
+            auto& bid = orderPool_.Hot(bidHandle);
+            auto& ask = orderPool_.Hot(askHandle);
+
+            const Quantity quantity = std::min(bid.remainingQuantity_, ask.remainingQuantity_);
+
+            bid.remainingQuantity_ -= quantity;
+            ask.remainingQuantity_ -= quantity;
+            const bool bidFilled = bid.remainingQuantity_ == 0 && !HasReserve(bidLevel, bidHandle);
+            const bool askFilled = ask.remainingQuantity_ == 0 && !HasReserve(askLevel, askHandle);
+
+            onTrade(
                 Trade{
-                    TradeInfo{ bid->GetOrderId(), bid->GetPrice(), quantity },
-                    TradeInfo{ ask->GetOrderId(), ask->GetPrice(), quantity }
+                    TradeInfo{ bid.orderId_, price, quantity },
+                    TradeInfo{ ask.orderId_, price, quantity }
                 }
             );
+
+            // no aggressor in an auction: the feed gets the side of the surplus, the one that set the price.
+            NotePrint(price);
+            if (marketData_){
+                marketData_->Publish(MarketDataMessage::TradePrint(symbol_, uncross.surplusSide_, price, quantity));
+            }
+
+            OnOrderMatched(bidLevel, Side::Buy, bidPrice, quantity, bidFilled);
+            OnOrderMatched(askLevel, Side::Sell, askPrice, quantity, askFilled);
+
+            if (bidFilled){
+                orderPool_.Erase(bids, bidHandle);
+                orders_.Erase(bid.orderId_);
+                ForgetOwner(bidHandle);
+                orderPool_.Release(bidHandle);
+            } else if (bid.remainingQuantity_ == 0){
+                Replenish(bidLevel, Side::Buy, bidPrice, bidHandle);
+            }
+
+            if (askFilled){
+                orderPool_.Erase(asks, askHandle);
+                orders_.Erase(ask.orderId_);
+                ForgetOwner(askHandle);
+                orderPool_.Release(askHandle);
+            } else if (ask.remainingQuantity_ == 0){
+                Replenish(askLevel, Side::Sell, askPrice, askHandle);
+            }
         }
-    }
-    if (!bids_.empty()){
-        auto& [_, bids] = *bids_.begin();  // get the most probable bid Order list at a price
-        auto& order = bids.front();  // get the first order
-        if (order->GetOrderType() == OrderType::FillAndKill){
-            CancelOrder(order->GetOrderId());
+
+        if (bids.empty()){
+            bids_.Erase(bidPrice);
         }
-    }
 
-    if (!asks_.empty()){
-        auto& [_, asks] = *asks_.begin();
-        auto& order = asks.front();  // get the first order
-        if (order->GetOrderType() == OrderType::FillAndKill){
-            CancelOrder(order->GetOrderId());
+        if (asks.empty()){
+            asks_.Erase(askPrice);
         }
     }
-    return trades;
 }
 
 // ? [this] -> lambda capture -> It allows a lambda function to access the members and
@@ -138,9 +405,34 @@ Trades OrderBook::MatchOrders(){
     * By putting `this` in the brackets, you are passing a ptr to the current isntances of the OrderBook class into the lambda.
  * `{ PruenGoodForDayOrders(); }`
  */
-OrderBook::OrderBook() : ordersPruneThread_{ [this] { PruneGoodForDayOrders(); }} {}
-// Alternative
-// OrderBook::OrderBook() : ordersPruneThread_{ [this] () { this->PruneGoodForDayOrders(); } } {}
+OrderBook::OrderBook() : OrderBook(OrderBookConfig{}) {}
+
+OrderBook::OrderBook(const OrderBookConfig& config)
+    : orderPool_{ config.expectedOrders_ }
+    , asks_{ config.ladderBasePrice_, config.ladderTickSize_, config.ladderLevels_, &nodeResource_ }
+    , bids_{ config.ladderBasePrice_, config.ladderTickSize_, config.ladderLevels_, &nodeResource_ }
+    , singleWriter_{ config.singleWriter_ }
+    , riskLimits_{ config.risk_ }
+    , orders_{ config.expectedOrders_ }
+    , expiries_{ config.expiryTick_, config.expirySlots_, std::chrono::system_clock::now() }
+    , expiryChunk_{ std::max<std::size_t>(config.expiryChunk_, 1) }
+    , expiryTick_{ config.expiryTick_ }
+    , pruneCpu_{ config.pruneCpu_ }
+    , goodForDayCutoff_{ NextGoodForDayCutoff(std::chrono::system_clock::now()) }
+    , marketData_{ config.marketData_ }
+    , symbol_{ config.symbol_ }
+    , journal_{ config.journal_ }
+{
+    dueExpiries_.reserve(expiryChunk_);
+
+    // A single-writer book belongs to one thread -> that thread calls ExpireOrders() itself.
+    if (singleWriter_) return;
+
+    // ! Start the thread only once every member it touches (the mutex, the condition variable, orders_, expiries_) is constructed.
+    ordersPruneThread_ = std::thread{ [this] { PruneExpiredOrders(); } };
+    // Alternative
+    // ordersPruneThread_ = std::thread{ [this] () { this->PruneExpiredOrders(); } };
+}
 
 OrderBook::~OrderBook() {
     shutdown_.store(true, std::memory_order_release);
@@ -151,121 +443,457 @@ OrderBook::~OrderBook() {
 }
 
 Trades OrderBook::AddOrder(OrderPointer order){
+    return AddOrder(*order);
+}
+
+Trades OrderBook::AddOrder(const Order& order){
+    Trades trades;
+    AddOrder(order, AppendTo(trades));
+    return trades;
+}
+
+OrderResult OrderBook::AddOrder(const Order& order, TradeSink onTrade){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::AddOrder };
+    auto ordersLock = LockOrders();
+
+    if (ExpiresOnArrival(order.GetOrderType(), order.GetExpiry()))
+        return OrderResult::Malformed;
+
+    JournalCommand(OrderCommand::Add(order));
+    const OrderResult result = AddOrderInternals(order, onTrade);
+    ReleaseStops(onTrade);
+    PublishTopOfBook();
+    return result;
+}
+
+template <Side S, OrderType T>
+OrderResult OrderBook::AddOrder(const Order& order, TradeSink onTrade){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::AddOrder };
+    auto ordersLock = LockOrders();
+
+    // S and T pick the ladder the order is linked into: one that does not match its own side and type would corrupt the book.
+    if (order.GetSide() != S || order.GetOrderType() != T)
+        return OrderResult::Malformed;
+
+    if constexpr (T == OrderType::GoodTillDate){
+        if (ExpiresOnArrival(T, order.GetExpiry()))
+            return OrderResult::Malformed;
+    }
+
+    JournalCommand(OrderCommand::Add(order));
+    const OrderResult result = AddOrderInternals<S, T>(order, onTrade);
+    ReleaseStops(onTrade);
+    PublishTopOfBook();
+    return result;
+}
+
+void OrderBook::AddOrders(std::span<const Order> orders, Trades& trades){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::Batch };
+    auto appendTrade = AppendTo(trades);
+    auto ordersLock = LockOrders();
+
+    for (const auto& order : orders){
+        if (ExpiresOnArrival(order.GetOrderType(), order.GetExpiry()))
+            continue;
+        JournalCommand(OrderCommand::Add(order));
+        AddOrderInternals(order, appendTrade);
+        ReleaseStops(appendTrade);
+    }
+
+    PublishTopOfBook();
+}
+
+OrderResult OrderBook::AddOrderInternals(const Order& order, TradeSink onTrade){
+    // the one runtime branch on the way in: commands off a queue or the journal do not know their type at compile time.
+    auto Dispatch = [&]<Side S>(){
+        switch (order.GetOrderType()){
+            case OrderType::GoodTillCancel: return AddOrderInternals<S, OrderType::GoodTillCancel>(order, onTrade);
+            case OrderType::FillAndKill: return AddOrderInternals<S, OrderType::FillAndKill>(order, onTrade);
+            case OrderType::FillOrKill: return AddOrderInternals<S, OrderType::FillOrKill>(order, onTrade);
+            case OrderType::GoodForDay: return AddOrderInternals<S, OrderType::GoodForDay>(order, onTrade);
+            case OrderType::Market: return AddOrderInternals<S, OrderType::Market>(order, onTrade);
+            case OrderType::GoodTillDate: return AddOrderInternals<S, OrderType::GoodTillDate>(order, onTrade);
+            case OrderType::Stop: return AddOrderInternals<S, OrderType::Stop>(order, onTrade);
+            case OrderType::StopLimit: return AddOrderInternals<S, OrderType::StopLimit>(order, onTrade);
+        }
+        return OrderResult::Malformed;
+    };
+
+    if (order.GetSide() == Side::Buy){
+        return Dispatch.template operator()<Side::Buy>();
+    }
+    return Dispatch.template operator()<Side::Sell>();
+}
+
+template <Side S, OrderType T>
+OrderResult OrderBook::AddOrderInternals(const Order& newOrder, TradeSink onTrade){
     /*
      * FIFO for queue for each price level
+     * Every `if constexpr` below is the policy of one order type -> a GoodTillCancel order pays for none of them.
      */
-    std::scoped_lock ordersLock{ orderMutex_ };
 
-    // if the order already exists in the order book.
-    if (orders_.contains(order->GetOrderId())){
-        return {};
+    if (newOrder.GetInitialQuantity() == 0){
+        return OrderResult::InvalidQuantity;
     }
 
-    // logic for market order
-    if (order->GetOrderType() == OrderType::Market){
-        if (order->GetSide() == Side::Buy && !asks_.empty()){
-            const auto& [worstAsk, _] = *asks_.rbegin();
-            order->ToGoodTillCancel(worstAsk);
-        } else if (order->GetSide() == Side::Sell && !bids_.empty()){
-            const auto& [worstBid, _] = *bids_.rbegin();
-            order->ToGoodTillCancel(worstBid);
-        } else
-            return {};  // invalid Order
+    // a market order (or a stop, which becomes one) takes whatever price it gets, every other one needs a limit.
+    if constexpr (T != OrderType::Market && T != OrderType::Stop){
+        if (newOrder.GetPrice() == Constants::InvalidPrice)
+            return OrderResult::InvalidPrice;
     }
 
-    if (
-        order->GetOrderType() == OrderType::FillAndKill &&
-        !CanMatch(order->GetSide(), order->GetPrice())
-    )
-        return {};
+    // if the order already exists in the order book, resting or waiting for its trigger.
+    if (orders_.Contains(newOrder.GetOrderId()) || (!stops_.empty() && stops_.Contains(newOrder.GetOrderId()))){
+        return OrderResult::DuplicateOrderId;
+    }
 
-    if (
-        order->GetOrderType() == OrderType::FillOrKill &&
-        !CanFullyFill(order->GetSide(), order->GetPrice(), order->GetInitialQuantity())
-    )
-        return {};
+    if constexpr (Risk::PreTrade){
+        const OrderResult risk = CheckPreTrade<S, T>(newOrder);
+        if (risk != OrderResult::Ok)
+            return risk;
+    }
 
-    OrderPointers::iterator iterator;  // ?
+    // a stop is only held until ReleaseStops() sees a trade through its stop price -> nothing to match yet.
+    if constexpr (T == OrderType::Stop || T == OrderType::StopLimit){
+        if (newOrder.GetStopPrice() == Constants::InvalidPrice)
+            return OrderResult::InvalidPrice;
+        if (newOrder.GetDisplayQuantity() != 0)
+            return OrderResult::InvalidQuantity;  // no iceberg stops: the journal keeps either a stop price or a display size
+        stops_.Add(newOrder);
+        return OrderResult::Ok;
+    }
 
-    if (order->GetSide() == Side::Buy){
-        auto& orders = bids_[order->GetPrice()];
-        orders.push_back(order);
-        iterator = std::prev(orders.end());
-    } else {
-        auto& orders = asks_[order->GetPrice()];
-        orders.push_back(order);
-        iterator = std::prev(orders.end());
+    // nothing trades before the uncross: an order that cannot rest has nothing to do in the auction.
+    if constexpr (T == OrderType::Market || T == OrderType::FillAndKill || T == OrderType::FillOrKill){
+        if (inAuction_)
+            return OrderResult::NotExecuted;
     }
 
-    orders_.insert({ order->GetOrderId(), OrderEntry{ order, iterator }});
+    if constexpr (T == OrderType::FillOrKill){
+        if (!CanFullyFill<S>(newOrder.GetPrice(), newOrder.GetInitialQuantity()))
+            return OrderResult::NotExecuted;
+        if constexpr (Risk::PreventsSelfTrade){
+            if (newOrder.GetOwner() != NoOwner && !CanFullyFillWithoutSelfTrade<S>(newOrder))
+                return OrderResult::NotExecuted;
+        }
+    }
 
-    OnOrderAdded(order);
+    // Market, FAK and (once it is known to fill) FOK orders never rest -> swept straight off the incoming order.
+    if constexpr (T == OrderType::Market || T == OrderType::FillAndKill || T == OrderType::FillOrKill){
+        return SweepOrders<S, T>(newOrder, onTrade);
+    }
+
+    // a GoodTillDate order without a date would rest as a GoodTillCancel one.
+    if constexpr (T == OrderType::GoodTillDate){
+        if (newOrder.GetExpiry() == NoExpiry)
+            return OrderResult::Malformed;
+    }
+
+    Order order = newOrder;  // our own copy, the GoodForDay logic below sets its expiry.
+
+    // every GoodForDay order rests until the next close, known upfront -> no clock read on the order path.
+    // One that has an expiry already is a replayed one: it keeps the close of the day it was journaled on.
+    if constexpr (T == OrderType::GoodForDay){
+        if (order.GetExpiry() == NoExpiry)
+            order.SetExpiry(goodForDayCutoff_);
+    }
 
-    return MatchOrders();
+    const OrderHandle handle = orderPool_.Allocate(order);
+    LinkOrder<S>(handle);
+
+    orders_.Insert(order.GetOrderId(), handle);
+    RememberOwner(handle);
+
+    // ! in an auction the order just rests, crossing or not -> Uncross() matches the whole book in one go.
+    const OrderResult result = inAuction_ ? OrderResult::Ok : MatchOrders<S>(onTrade);
+
+    // only what is left resting can expire -> an order filled on arrival never reaches the wheel.
+    if constexpr (T == OrderType::GoodForDay || T == OrderType::GoodTillDate){
+        if (orders_.Contains(order.GetOrderId())){
+            expiries_.Schedule(order.GetOrderId(), order.GetExpiry());
+        }
+    }
+    return result;
 }
 
 Trades OrderBook::ModifyOrder(OrderModify order){
-    OrderType orderType;
+    Trades trades;
+    ModifyOrder(order, AppendTo(trades));
+    return trades;
+}
 
-    {
-        // RAII-style Lock Acquire
-        std::scoped_lock ordersLock{ orderMutex_ };
+OrderResult OrderBook::ModifyOrder(const OrderModify& order, TradeSink onTrade){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::ModifyOrder };
+    // RAII-style Lock Acquire -> the cancel and the re-add happen in the same critical section.
+    auto ordersLock = LockOrders();
+
+    JournalCommand(OrderCommand::Modify(order));
+    const OrderResult result = ModifyOrderInternals(order, onTrade);
+    ReleaseStops(onTrade);
+    PublishTopOfBook();
+    return result;
+}
+
+OrderResult OrderBook::ModifyOrderInternals(const OrderModify& modify, TradeSink onTrade){
+    const OrderHandle handle = orders_.Find(modify.GetOrderId());
+    if (handle == InvalidOrderHandle)
+        return OrderResult::UnknownOrderId;
+
+    if (modify.GetQuantity() == 0){
+        return CancelOrderInternals(modify.GetOrderId());
+    }
+
+    if (modify.GetPrice() == Constants::InvalidPrice)
+        return OrderResult::InvalidPrice;
+
+    Order order = orderPool_.Load(handle);  // cold path -> work on the whole order, write it back once amended
+
+    if constexpr (Risk::PreTrade){
+        const OrderResult risk = CheckAmend(order, modify);
+        if (risk != OrderResult::Ok)
+            return risk;
+    }
+
+    // ! quantity down at the same price -> amend in place, the order keeps its priority.
+    if (
+        order.GetSide() == modify.GetSide() &&
+        order.GetPrice() == modify.GetPrice() &&
+        modify.GetQuantity() <= order.GetRemainingQuantity()
+    ){
+        // an iceberg gives up its hidden part first: what shows never grows in place, only a requeued slice can be bigger.
+        const Quantity visible = orderPool_.Hot(handle).remainingQuantity_;
+        const Quantity newVisible = std::min(visible, modify.GetQuantity());
+        auto& iceberg = orderPool_.Iceberg(handle);
+        const Quantity newHidden = modify.GetQuantity() - newVisible;
+
+        auto& level = order.GetSide() == Side::Buy ? *bids_.Find(order.GetPrice()) : *asks_.Find(order.GetPrice());
+        level.data_.hidden_ = level.data_.hidden_ - iceberg.hidden_ + newHidden;
+        UpdateLevelData(level, order.GetSide(), order.GetPrice(), visible - newVisible, LevelData::Action::Match);
+        ChargeCredit(handle, true);
+        order.Amend(modify.GetSide(), modify.GetPrice(), modify.GetQuantity());
+        orderPool_.Store(handle, order);
+        ChargeCredit(handle, false);
+        orderPool_.Hot(handle).remainingQuantity_ = newVisible;
+        iceberg.hidden_ = newHidden;
+        return OrderResult::Ok;
+    }
+
+    // everything else loses priority: same slot, same entry in orders_ (and the same expiry), only relinked.
+    UnlinkOrder(handle);
+    ChargeCredit(handle, true);
+    order.Amend(modify.GetSide(), modify.GetPrice(), modify.GetQuantity());
+    orderPool_.Store(handle, order);
+    ChargeCredit(handle, false);
+    LinkOrder(handle);
+
+    // a new price can cross the spread (left crossed until the uncross in an auction).
+    return inAuction_ ? OrderResult::Ok : MatchOrders(modify.GetSide(), onTrade);
+}
+
+Trades OrderBook::Apply(const OrderCommand& command){
+    Trades trades;
+    Apply(command, AppendTo(trades));
+    return trades;
+}
+
+OrderResult OrderBook::Apply(const OrderCommand& command, TradeSink onTrade){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::Apply };
+    auto ordersLock = LockOrders();
+
+    if (command.type_ == CommandType::Add && ExpiresOnArrival(command.orderType_, command.expiry_))
+        return OrderResult::Malformed;
+
+    JournalCommand(command);
+    const OrderResult result = ApplyInternals(command, onTrade);
+    ReleaseStops(onTrade);
+    PublishTopOfBook();
+    return result;
+}
+
+void OrderBook::ProcessBatch(std::span<const OrderCommand> commands, Trades& trades){
+    ProcessBatch(commands, AppendTo(trades));
+}
+
+void OrderBook::ProcessBatch(std::span<const OrderCommand> commands, TradeSink onTrade){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::Batch };
+    // one lock for the whole batch, and every command reports to the same sink.
+    auto ordersLock = LockOrders();
+
+    for (const auto& command : commands){
+        if (command.type_ == CommandType::Add && ExpiresOnArrival(command.orderType_, command.expiry_))
+            continue;
+        JournalCommand(command);
+        ApplyInternals(command, onTrade);
+        ReleaseStops(onTrade);
+    }
+
+    PublishTopOfBook();
+}
+
+OrderResult OrderBook::ApplyInternals(const OrderCommand& command, TradeSink onTrade){
+    switch (command.type_){
+        case CommandType::Add:
+            return AddOrderInternals(command.ToOrder(), onTrade);
+        case CommandType::Cancel:
+            if (!SentByOwner(command.orderId_, command.owner_))
+                return OrderResult::NotOwner;
+            return CancelOrderInternals(command.orderId_);
+        case CommandType::Modify:
+            if (!SentByOwner(command.orderId_, command.owner_))
+                return OrderResult::NotOwner;
+            return ModifyOrderInternals(command.ToOrderModify(), onTrade);
+        case CommandType::BeginAuction:
+            return BeginAuctionInternals();
+        case CommandType::Uncross:
+            return UncrossInternals(onTrade);
+    }
+    return OrderResult::Malformed;
+}
+
+void OrderBook::BeginAuction(){
+    auto ordersLock = LockOrders();
+
+    JournalCommand(OrderCommand::BeginAuction());
+    BeginAuctionInternals();
+}
+
+Trades OrderBook::Uncross(){
+    Trades trades;
+    Uncross(AppendTo(trades));
+    return trades;
+}
+
+OrderResult OrderBook::Uncross(TradeSink onTrade){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::Uncross };
+    auto ordersLock = LockOrders();
+
+    JournalCommand(OrderCommand::Uncross());
+    const OrderResult result = UncrossInternals(onTrade);
+    ReleaseStops(onTrade);  // the uncross prints like any trade: stops through its price are released into continuous trading
+    PublishTopOfBook();
+    return result;
+}
+
+AuctionInfo OrderBook::GetAuctionInfo() const {
+    auto ordersLock = LockOrders();
+    return ComputeUncross();  // outside an auction the book never crosses -> nothing
+}
+
+bool OrderBook::InAuction() const {
+    auto ordersLock = LockOrders();
+    return inAuction_;
+}
 
-        if (!orders_.contains(order.GetOrderId()))
-            return {};
+OrderResult OrderBook::BeginAuctionInternals(){
+    inAuction_ = true;  // already in one -> nothing changes
+    return OrderResult::Ok;
+}
 
-        const auto& [existingOrder, _] = orders_.at(order.GetOrderId());
-        orderType = existingOrder->GetOrderType();
-    }  // Release the lock here
+OrderResult OrderBook::UncrossInternals(TradeSink onTrade){
+    if (!inAuction_)
+        return OrderResult::NotExecuted;
 
-    CancelOrder(order.GetOrderId());
-    return AddOrder(order.ToOrderPointer(orderType));
+    inAuction_ = false;
+    for (AuctionInfo uncross = ComputeUncross(); uncross.Crosses(); uncross = ComputeUncross()){
+        UncrossOrders(uncross, onTrade);
+        // one round leaves the book uncrossed, unless self-trade prevention took volume out of it -> then again at the new price.
+        if constexpr (!Risk::PreventsSelfTrade) break;
+    }
+    return OrderResult::Ok;
 }
 
 std::size_t OrderBook::Size() const { return orders_.size(); }
 
+std::size_t OrderBook::PendingStops() const {
+    auto ordersLock = LockOrders();
+    return stops_.size();
+}
+
+void OrderBook::ReleaseTriggeredStops(TradeSink onTrade){
+    // every round takes the prints of the one before: the trades of the stops released can trigger more of them.
+    while (printLow_ <= printHigh_){
+        const Price low = printLow_;
+        const Price high = printHigh_;
+        printLow_ = std::numeric_limits<Price>::max();
+        printHigh_ = std::numeric_limits<Price>::min();
+
+        if (!stops_.Triggers(low, high)) return;
+
+        triggeredStops_.clear();
+        stops_.Collect(low, high, triggeredStops_);
+
+        // through the normal add path, as the order each one was waiting to become. Not journaled: the replay triggers them again.
+        for (auto& order : triggeredStops_){
+            order.Trigger();
+            AddOrderInternals(order, onTrade);
+        }
+    }
+}
+
 OrderBookLevelInfos OrderBook::GetOrderInfos() const {
+    auto ordersLock = LockOrders();
+
     LevelInfos bidInfos, askInfos;
     bidInfos.reserve(bids_.size());
     askInfos.reserve(asks_.size());
 
-    auto CreateLevelInfos = [](Price price, const OrderPointers& orders){
-        return LevelInfo{price, std::accumulate(
-            orders.begin(), orders.end(), (Quantity)0,
-            [](std::size_t runningSum, const OrderPointer& order)
-            { return runningSum + order->GetRemainingQuantity(); } )};
-    };
+    // the level totals are maintained incrementally -> no need to walk the orders of each level.
+    bids_.ForEach([&](Price price, const PriceLevel& level){
+        bidInfos.push_back(LevelInfo{ price, level.data_.quantity_ });
+        return true;
+    });
 
-    for (const auto& [price, orders] : bids_){
-        bidInfos.push_back(CreateLevelInfos(price, orders));
-    }
+    asks_.ForEach([&](Price price, const PriceLevel& level){
+        askInfos.push_back(LevelInfo{ price, level.data_.quantity_ });
+        return true;
+    });
 
-    for (const auto& [price, orders]: asks_) {
-        askInfos.push_back(CreateLevelInfos(price, orders));
-    }
+    return OrderBookLevelInfos{ std::move(bidInfos), std::move(askInfos) };
+}
+
+std::size_t OrderBook::GetDepth(Side side, std::span<LevelInfo> levels) const {
+    auto ordersLock = LockOrders();
 
-    return OrderBookLevelInfos{ bidInfos, askInfos };
+    std::size_t count = 0;
+    auto CopyLevel = [&](Price price, const PriceLevel& level){
+        if (count == levels.size()) return false;  // the caller's buffer is full -> stop walking
+        levels[count++] = LevelInfo{ price, level.data_.quantity_ };
+        return true;
+    };
+
+    if (side == Side::Buy){
+        bids_.ForEach(CopyLevel);
+    } else {
+        asks_.ForEach(CopyLevel);
+    }
+    return count;
 }
 
-void OrderBook::PruneGoodForDayOrders(){
+std::chrono::system_clock::time_point OrderBook::NextGoodForDayCutoff(std::chrono::system_clock::time_point now){
     using namespace std::chrono;
     const auto end = hours(16);
 
-    while (true){
-        const auto now = system_clock::now();
-        const auto now_c = system_clock::to_time_t(now);
-        std::tm now_parts;
-        localtime_r(&now_c, &now_parts);
+    const auto now_c = system_clock::to_time_t(now);
+    std::tm now_parts;
+    localtime_r(&now_c, &now_parts);
+
+    if (now_parts.tm_hour >= end.count())
+        now_parts.tm_mday += 1;
 
-        if (now_parts.tm_hour >= end.count())
-            now_parts.tm_mday += 1;
+    now_parts.tm_hour = end.count();
+    now_parts.tm_min = 0;
+    now_parts.tm_sec = 0;
 
-        now_parts.tm_hour = end.count();
-        now_parts.tm_min = 0;
-        now_parts.tm_sec = 0;
+    return system_clock::from_time_t(mktime(&now_parts));
+}
+
+void OrderBook::PruneExpiredOrders(){
+    using namespace std::chrono;
+    PinCurrentThread(pruneCpu_);  // off the cores the callers match on
 
-        auto next = system_clock::from_time_t(mktime(&now_parts));
-        auto till = next - now + milliseconds(100);
+    while (true){
+        // wake up once per expiry tick, that is the resolution of the wheel anyway.
+        const auto till = expiryTick_;
 
         {
             // RAII pattern for mutex management -> similar to python context management?
@@ -279,98 +907,291 @@ void OrderBook::PruneGoodForDayOrders(){
                 shutdown_.load(std::memory_order_acquire) ||  // check if the app is already trying to shut down. -> if yes -> return
                 // std::memory_order_acquire -> a C++11 atomic memory ordering constraint for load operations that
                 // ensures no subsequent memory reads or writes in the current thread are reordered before it.
-                shutdownConditionVariable_.wait_for(ordersLock, till) == std::cv_status::no_timeout  // go to sleep until 4:00 pm or until notified
+                shutdownConditionVariable_.wait_for(ordersLock, till) == std::cv_status::no_timeout  // go to sleep for a tick or until notified
                 // `== std::cv_status::no_timeout` => when wait_for finishes, it returnsa  status telling you why it woke up.
-                // if it returns std::cv_status::timeout -> Then it has hitted 16:00
+                // if it returns std::cv_status::timeout -> Then the tick is over
                 // if it returns std::cv_status::no_timeout -> then another thread explicitly notified the conitional_variable. (so interrupt/signal from external source)
                 // `std::cv_status`: condition_variable used to indicate the result of a timed-wait on a conditional variable.
             )
                 return;
         }
 
-        OrderIds orderIds;
+        // one chunk per lock acquisition -> orders keep flowing in between, even when a whole day expires at once.
+        while (!ExpireOrders(system_clock::now()) && !shutdown_.load(std::memory_order_acquire)){}
+    }
+}
 
-        {
-            // RAII pattern for mutex management.
+bool OrderBook::ExpireOrders(Timestamp now){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::ExpireOrders };
+    auto ordersLock = LockOrders();
 
-            std::scoped_lock ordersLock{ orderMutex_ };
+    expiredUpTo_ = std::max(expiredUpTo_, now);
+    if (now >= goodForDayCutoff_){
+        // the GoodForDay orders added from now on rest until the next close.
+        goodForDayCutoff_ = NextGoodForDayCutoff(now);
+    }
 
-            for (const auto& [_, entry] : orders_){
-                const auto& [order, _] = entry;
+    dueExpiries_.clear();
+    const bool done = expiries_.Collect(now, expiryChunk_, dueExpiries_);
 
-                if (order->GetOrderType() != OrderType::GoodForDay)
-                    continue;
+    for (const auto& [orderId, expiry] : dueExpiries_){
+        const OrderHandle handle = orders_.Find(orderId);
 
-                orderIds.push_back(order->GetOrderId());
-            }
-        }
+        // stale entry: the order has left the book since, or its ID now belongs to an order with another expiry.
+        if (handle == InvalidOrderHandle || orderPool_.Cold(handle).expiry_ != expiry)
+            continue;
 
-        CancelOrders(orderIds);
+        // journaled as a plain cancel -> a replay does not depend on when it runs.
+        JournalCommand(OrderCommand::Cancel(orderId));
+        CancelOrderInternals(orderId);
     }
+
+    PublishTopOfBook();
+    return done;
 }
 
-void OrderBook::CancelOrders(OrderIds orderIds){
+void OrderBook::CancelOrders(std::span<const OrderId> orderIds){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::Batch };
     // acquire mutex for data.
-    std::scoped_lock orderLock{ orderMutex_ };
+    auto orderLock = LockOrders();
 
     for (const auto& orderId : orderIds){
+        JournalCommand(OrderCommand::Cancel(orderId));
         CancelOrderInternals(orderId);
     }
+
+    PublishTopOfBook();
+}
+
+OrderResult OrderBook::CancelOrderInternals(OrderId orderId){
+    // need to erase the given orderId from the index: orders_ -> found and removed in the same probe.
+    const OrderHandle handle = orders_.Erase(orderId);
+    if (handle == InvalidOrderHandle){
+        // not resting -> maybe still waiting for its trigger, otherwise the given orderId does not exist.
+        return !stops_.empty() && stops_.Cancel(orderId) ? OrderResult::Ok : OrderResult::UnknownOrderId;
+    }
+
+    // now need to erase the given order from its price level, then give its slot back.
+    UnlinkOrder(handle);
+    ForgetOwner(handle);
+    orderPool_.Release(handle);
+    return OrderResult::Ok;
+}
+
+bool OrderBook::SentByOwner(OrderId orderId, OwnerId owner) const {
+    if (owner == NoOwner) return true;
+
+    const OrderHandle handle = orders_.Find(orderId);
+    if (handle != InvalidOrderHandle) return orderPool_.Ownership(handle).owner_ == owner;
+
+    const Order* stop = stops_.empty() ? nullptr : stops_.Find(orderId);
+    return stop == nullptr || stop->GetOwner() == owner;
+}
+
+void OrderBook::RememberOwner(OrderHandle handle){
+    const OwnerId owner = orderPool_.Ownership(handle).owner_;
+    if (owner == NoOwner) return;
+
+    auto& entry = owners_[owner];
+    orderPool_.PushBackOwned(entry.orders_, handle);
+    if constexpr (Risk::CheckOwnerCredit){
+        const auto& order = orderPool_.Cold(handle);
+        entry.exposure_ += Notional(order.price_, order.initialQuantity_);
+    }
 }
 
-void OrderBook:: CancelOrderInternals(OrderId orderId){
-    // the given orderId doe snot exist
-    if (orders_.find(orderId) == orders_.end()){
-        return;
+void OrderBook::ForgetOwner(OrderHandle handle){
+    const OwnerId owner = orderPool_.Ownership(handle).owner_;
+    if (owner == NoOwner) return;
+
+    const auto entry = owners_.find(owner);
+    orderPool_.EraseOwned(entry->second.orders_, handle);
+    if constexpr (Risk::CheckOwnerCredit){
+        const auto& order = orderPool_.Cold(handle);
+        entry->second.exposure_ -= Notional(order.price_, order.initialQuantity_);
+    }
+    if (entry->second.orders_.empty()){
+        owners_.erase(entry);  // only owners with resting orders are kept
     }
+}
 
-    // need to erase the given orderId from the unordered_map: orders_.
-    const auto orderIterator_ = orders_.find(orderId);
-    if (orderIterator_ == orders_.end()) return;
+void OrderBook::ChargeCredit(OrderHandle handle, bool refund){
+    if constexpr (Risk::CheckOwnerCredit){
+        const OwnerId owner = orderPool_.Ownership(handle).owner_;
+        if (owner == NoOwner) return;
 
-    const auto& [orderId_, orderEntry_] = *orderIterator_;
-    const auto order = orderEntry_.order_;  // pointer to the corresponding order object.
-    const auto orderIterator = orderEntry_.location_;
+        const auto& order = orderPool_.Cold(handle);
+        const std::uint64_t notional = Notional(order.price_, order.initialQuantity_);
+        auto& exposure = owners_.find(owner)->second.exposure_;
+        exposure = refund ? exposure - notional : exposure + notional;
+    }
+}
 
-    orders_.erase(orderId);
+std::size_t OrderBook::CancelOwnerOrders(OwnerId owner){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::Batch };
+    auto ordersLock = LockOrders();
+
+    if (owner == NoOwner) return 0;
+
+    std::size_t count = 0;
+    const auto entry = owners_.find(owner);
+    if (entry != owners_.end()){
+        // ! each cancel takes the head off the owner's list, and the last one erases the list itself -> count upfront.
+        count = entry->second.orders_.size();
+        for (std::size_t i = 0; i < count; ++i){
+            const OrderId orderId = orderPool_.Hot(entry->second.orders_.head_).orderId_;
+            JournalCommand(OrderCommand::Cancel(orderId));
+            CancelOrderInternals(orderId);
+        }
+    }
 
-    // now need to erase the given order id from the map for bids and asks based on the OrderType.
-    if (order->GetSide() == Side::Sell){
-        auto price = order->GetPrice();
-        auto& orders = asks_.at(price);
-        orders.erase(orderIterator);  // remove the given order from the list of orders (sell) on the given price level.
-        if (orders.empty()){  // remove this price from the asks entirely.
-            asks_.erase(price);
+    // ! the stops are not on the owner's list (they have no pool slot yet) -> a scan of the pending ones, if any.
+    if (!stops_.empty()){
+        massCancelIds_.clear();
+        stops_.CollectOwner(owner, massCancelIds_);
+        for (const OrderId orderId : massCancelIds_){
+            JournalCommand(OrderCommand::Cancel(orderId));
+            CancelOrderInternals(orderId);
         }
+        count += massCancelIds_.size();
     }
 
-    if (order->GetSide() == Side::Buy){
-        auto price = order->GetPrice();
-        auto& orders = bids_.at(price);
-        orders.erase(orderIterator);
-        if (orders.empty()){
-            bids_.erase(price);
+    PublishTopOfBook();
+    return count;
+}
+
+std::size_t OrderBook::CancelSide(Side side){
+    return CancelPriceRange(side, std::numeric_limits<Price>::min(), std::numeric_limits<Price>::max());
+}
+
+std::size_t OrderBook::CancelPriceRange(Side side, Price low, Price high){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::Batch };
+    auto ordersLock = LockOrders();
+
+    if (low > high) return 0;
+
+    // walked from the better end of the range: the highest bid, the lowest ask.
+    const std::size_t count = side == Side::Buy
+        ? CancelLevelsInternals<Side::Buy>(high, low)
+        : CancelLevelsInternals<Side::Sell>(low, high);
+
+    PublishTopOfBook();
+    return count;
+}
+
+template <Side S>
+std::size_t OrderBook::CancelLevelsInternals(Price from, Price to){
+    // collect first, cancel after: a cancel can erase the level the walk stands on.
+    massCancelIds_.clear();
+    Levels<S>().ForEachFrom(from, [&](Price price, const PriceLevel& level){
+        if (S == Side::Buy ? price < to : price > to) return false;  // past the worse end of the range
+
+        for (OrderHandle handle = orderPool_.Front(level.orders_); handle != InvalidOrderHandle; handle = orderPool_.Next(level.orders_, handle)){
+            massCancelIds_.push_back(orderPool_.Hot(handle).orderId_);
         }
+        return true;
+    });
+
+    for (const OrderId orderId : massCancelIds_){
+        JournalCommand(OrderCommand::Cancel(orderId));
+        CancelOrderInternals(orderId);
+    }
+    return massCancelIds_.size();
+}
+
+template <Side S>
+void OrderBook::LinkOrder(OrderHandle handle){
+    auto& level = Levels<S>()[orderPool_.Cold(handle).price_];
+    orderPool_.PushBack(level.orders_, handle);
+    OnOrderAdded(level, handle);
+}
+
+void OrderBook::LinkOrder(OrderHandle handle){
+    if (orderPool_.Cold(handle).side_ == Side::Buy){
+        LinkOrder<Side::Buy>(handle);
+    } else {
+        LinkOrder<Side::Sell>(handle);
+    }
+}
+
+void OrderBook::UnlinkOrder(OrderHandle handle){
+    const auto& order = orderPool_.Cold(handle);  // the slot stays valid until the caller releases it.
+    const auto price = order.price_;
+
+    if (order.side_ == Side::Sell){
+        auto& level = *asks_.Find(price);
+        OnOrderCancelled(level, handle);
+        orderPool_.Erase(level.orders_, handle);  // remove the given order from the list of orders (sell) on the given price level.
+        if (level.orders_.empty()){  // remove this price from the asks entirely.
+            asks_.Erase(price);
+        }
+    } else {
+        auto& level = *bids_.Find(price);
+        OnOrderCancelled(level, handle);
+        orderPool_.Erase(level.orders_, handle);
+        if (level.orders_.empty()){
+            bids_.Erase(price);
+        }
+    }
+}
+
+std::unique_lock<std::mutex> OrderBook::LockOrders() const {
+    if (singleWriter_){
+        return {};  // owns no mutex -> nothing to unlock either.
+    }
+
+    const auto ingress = Instrumentation::Now();
+    std::unique_lock lock{ orderMutex_ };
+    Instrumentation::Record(Instrumentation::Probe::LockWait, ingress, Instrumentation::Now());
+    return lock;
+}
+
+void OrderBook::OnOrderCancelled(PriceLevel& level, OrderHandle handle){
+    const auto& order = orderPool_.Cold(handle);
+    if (level.data_.hasIcebergs_){
+        level.data_.hidden_ -= orderPool_.Iceberg(handle).hidden_;
     }
+    UpdateLevelData(level, order.side_, order.price_, orderPool_.Hot(handle).remainingQuantity_, LevelData::Action::Remove);
 }
 
-void OrderBook::OnOrderCancelled(OrderPointer order){
-    UpdateLevelData(order->GetPrice(), order->GetRemainingQuantity(), LevelData::Action::Remove);
+void OrderBook::OnOrderAdded(PriceLevel& level, OrderHandle handle){
+    const auto& order = orderPool_.Cold(handle);
+    const auto& iceberg = orderPool_.Iceberg(handle);
+    if (iceberg.display_ != 0){
+        level.data_.hasIcebergs_ = true;
+        level.data_.hidden_ += iceberg.hidden_;
+    }
+    UpdateLevelData(level, order.side_, order.price_, orderPool_.Hot(handle).remainingQuantity_, LevelData::Action::Add);
 }
 
-void OrderBook::OnOrderAdded(OrderPointer order){
-    UpdateLevelData(order->GetPrice(), order->GetInitialQuantity(), LevelData::Action::Add);
+void OrderBook::Replenish(PriceLevel& level, Side side, Price price, OrderHandle handle){
+    auto& iceberg = orderPool_.Iceberg(handle);
+    const Quantity slice = std::min(iceberg.display_, iceberg.hidden_);
+    iceberg.hidden_ -= slice;
+    level.data_.hidden_ -= slice;
+    orderPool_.Hot(handle).remainingQuantity_ = slice;
+
+    // ! a new slice is a new order as far as time priority goes -> behind everything already resting at the price.
+    orderPool_.Erase(level.orders_, handle);
+    orderPool_.PushBack(level.orders_, handle);
+    UpdateLevelData(level, side, price, slice, LevelData::Action::Replenish);
 }
 
-void OrderBook::OnOrderMatched(Price price, Quantity quantity, bool isFullyFilled){
-    UpdateLevelData(price, quantity, LevelData::Action::Match);
+void OrderBook::OnOrderMatched(PriceLevel& level, Side side, Price price, Quantity quantity, bool isFullyFilled){
+    // a fill that completes the order also takes it off the level -> it counts as a removal.
+    UpdateLevelData(level, side, price, quantity, isFullyFilled ? LevelData::Action::Remove : LevelData::Action::Match);
 }
 
-void OrderBook::UpdateLevelData(Price price, Quantity quantity, LevelData::Action action){
+void OrderBook::UpdateLevelData(PriceLevel& level, Side side, Price price, Quantity quantity, LevelData::Action action){
     /*
-     * What does it do?
+     * Keep the aggregates of the given level in sync with the orders resting on it.
+     * The level itself is erased by the caller once its last order is gone.
      */
-    auto& data = data_[price];  // Returns LevelData, [price: LevelData]
+    auto& data = level.data_;
+
+    if (ShowsInTopOfBook(side, price)){
+        (side == Side::Buy ? bidsTopDirty_ : asksTopDirty_) = true;
+    }
 
     // update data count
     data.count_ += action == LevelData::Action::Remove ? -1 : action == LevelData::Action::Add ? 1 : 0;
@@ -379,93 +1200,420 @@ void OrderBook::UpdateLevelData(Price price, Quantity quantity, LevelData::Actio
     if (action == LevelData::Action::Remove || action == LevelData::Action::Match){
         data.quantity_ -= quantity;
     } else {
-        // LevelData::Action::Add
+        // LevelData::Action::Add, LevelData::Action::Replenish
         data.quantity_ += quantity;
     }
+    // the dense copy the feasibility scans run over -> reserves included, like LevelQuantity()
+    if (side == Side::Buy) bids_.SetQuantity(price, data.quantity_ + data.hidden_);
+    else asks_.SetQuantity(price, data.quantity_ + data.hidden_);
+
+    // every level change goes out as the level's new state, from here -> the feed cannot drift from the book.
+    if (marketData_){
+        const MarketDataType type =
+            data.count_ == 0 ? MarketDataType::DeleteLevel :
+            action == LevelData::Action::Add && data.count_ == 1 ? MarketDataType::AddLevel :
+            MarketDataType::ChangeLevel;
+        marketData_->Publish(MarketDataMessage::Level(symbol_, type, side, price, data.quantity_, data.count_));
+    }
+}
+
+bool OrderBook::ShowsInTopOfBook(Side side, Price price) const {
+    // a change at a level as good as the worst published one, or anywhere while that side is shallower than Depth.
+    if (side == Side::Buy){
+        return publishedTop_.bidLevels_ < TopOfBook::Depth || price >= publishedTop_.bids_[TopOfBook::Depth - 1].price_;
+    }
+    return publishedTop_.askLevels_ < TopOfBook::Depth || price <= publishedTop_.asks_[TopOfBook::Depth - 1].price_;
+}
 
-    // If there is no order anymore -> then just delete it from the data_
-    if (data.count_ == 0){
-        data_.erase(price);
+void OrderBook::RepublishTopOfBook(){
+    TopOfBook top = publishedTop_;
+    auto CopyLevels = [](LevelInfo* levels, std::uint32_t& count){
+        return [levels, &count](Price price, const PriceLevel& level){
+            levels[count++] = LevelInfo{ price, level.data_.quantity_ };
+            return count < TopOfBook::Depth;
+        };
+    };
+    if (bidsTopDirty_){
+        top.bidLevels_ = 0;
+        bids_.ForEach(CopyLevels(top.bids_, top.bidLevels_));
+    }
+    if (asksTopDirty_){
+        top.askLevels_ = 0;
+        asks_.ForEach(CopyLevels(top.asks_, top.askLevels_));
     }
 
-    return;
+    topOfBook_.Store(top);
+    publishedTop_ = top;
+    bidsTopDirty_ = asksTopDirty_ = false;
 }
 
-bool OrderBook::CanFullyFill(Side side, Price price, Quantity quantity) const {
+template <Side S>
+bool OrderBook::CanFullyFill(Price price, Quantity quantity) const {
     /*
      * The CanFullyKill function checks if an incoming FOK order can be completely executed immediately without leaving any remaining quantity
      * on the book. If it cannot be filled entirely, a FOK order should be rejected and killed.
      *
-     * It is trying to sum up the toal available volume that amatches the price criteria.
-     * Because addition is commutative, the order in which we sum up the valid levelData_.quantity_ does not matter,
-     * as long as we only sum up the quanitties at prices that are valid for the incoming order.
-     *
-     * need to check if the given quantity can be filled in the existing OrderBook Entries
-     * we need to figure out if the volumen presented is enough to cover the given quantity.
-     * if the given quantity can be filled -> Then return true; return false otherwise.
+     * Add up the maintained level quantities of the opposite side, from its best price up to the limit price of the order,
+     * and stop as soon as the quantity is covered.
+     * The window levels are summed from the ladder's dense quantity array (LevelScan, vectorised), a block of levels at a time,
+     * so a FOK costs O(levels it would consume / block), not O(levels in the book).
      *
      * if side == Side::BUY
-     * -> then we need to go through the asks_
+     * -> then we need to go through the asks_, lowest ask first, up to the limit price
      *
      * else if side == Side::SELL
-     * -> then we need to go through the bids_
+     * -> then we need to go through the bids_, highest bid first, down to the limit price
      */
 
     // check if there is a quantity where we can match, at least one quantity.
-    if (!CanMatch(side, price)){
+    if (!CanMatch<S>(price)){
         return false;
     }
 
-    // The optional contained value -> the value may or may not be present
-    // ? Threshold is the price for BBO/BAO => The starting point of prices we are allowed to consider.
-    // ? If I am a Buyer, I want to buy from the lowest asks going upwards.
-    // ? If I am a Seller, I want to sell from the highest bids going downwards.
-    std::optional<Price> threshold;
+    return Levels<Opposite<S>>().QuantityUpTo(price, quantity, LevelQuantity) >= quantity;
+}
 
-    if (side == Side::Buy){  // Buy -> get the best sell (asks) price
-        // ! _ does not give it any special magical properties -> so the OrderPointers would be "Copied" so it is better to use reference rather than the value copied.
-        const auto& [askPrice, _] = *asks_.begin();
-        threshold = askPrice;
-    } else {  // Sell -> get the best buy (bids) price
-        const auto& [bidPrice, _] = *bids_.begin();
-        threshold = bidPrice;
+template <Side S>
+bool OrderBook::CanFullyFillWithoutSelfTrade(const Order& order) const {
+    /*
+     * CanFullyFill() again, order by order this time, for a FOK whose owner may have orders on the other side:
+        * CancelNewest / CancelBoth -> the FOK would be cancelled on its first own order -> it has to be covered before that one
+        * CancelOldest -> its own orders would be cancelled out of the way -> they do not count
+     * Only ever run once CanFullyFill() said yes, i.e., on the levels it would consume at most.
+     */
+    const OwnerId owner = order.GetOwner();
+    const Quantity quantity = order.GetInitialQuantity();
+    std::uint64_t covered = 0;
+    bool blocked = false;
+
+    Levels<Opposite<S>>().ForEach([&](Price price, const PriceLevel& level){
+        if (S == Side::Buy ? price > order.GetPrice() : price < order.GetPrice()) return false;
+
+        for (OrderHandle handle = orderPool_.Front(level.orders_); handle != InvalidOrderHandle; handle = orderPool_.Next(level.orders_, handle)){
+            if (orderPool_.Ownership(handle).owner_ == owner){
+                if constexpr (Risk::CancelsNewest){
+                    blocked = true;
+                    return false;
+                }
+                continue;
+            }
+            covered += orderPool_.Hot(handle).remainingQuantity_;
+            if (level.data_.hasIcebergs_){
+                covered += orderPool_.Iceberg(handle).hidden_;  // as CanFullyFill(): the sweep takes the reserves as they show
+            }
+            if (covered >= quantity) return false;
+        }
+        return true;
+    });
+    return !blocked && covered >= quantity;
+}
+
+template <Side S, OrderType T>
+OrderResult OrderBook::CheckPreTrade(const Order& order) const {
+    if constexpr (Risk::CheckMaxQuantity){
+        if (order.GetInitialQuantity() > riskLimits_.maxOrderQuantity_)
+            return OrderResult::RiskRejected;
     }
 
-    // ! Syntax: Reference -> read only refernece to the elements already sitting inside the data_ map.
-    for (const auto& [levelPrice, levelData] : data_){
-        // check if the given condition is even possible
-        if (
-            threshold.has_value() &&  // if the threshold value is present
-            // threshold is the BAO, if the side is BUY
-            // threshold is the BBO, if the side is SELL
-            (
-                (side == Side::Buy && threshold.value() > levelPrice) ||  // if the random levelPrice is less than the BAO, then it is on Bids side
-                (side == Side::Sell && threshold.value() < levelPrice)  // if the random levelPRice is greater than the BBO, then it is on Asks side
-            )
-        )
-            continue;
+    // a Market order has no price to check, a stop none that means anything yet: it is checked again once triggered.
+    constexpr bool Priced = T != OrderType::Market && T != OrderType::Stop && T != OrderType::StopLimit;
 
-        // check if the given condition is desired by the client.
-        if (  // If the threshold value is not present
-            // price is the limit price, in the given order.
-            (side == Side::Buy && levelPrice > price) ||  // For BUY, if the levelPrice is greter than limitPrice, then I would not buy.
-            (side == Side::Sell && levelPrice < price)  // For SELL, if the levelPrice is less than limitPrice, then I would not sell.
-        )
-            continue;
+    if constexpr (Risk::CheckPriceBand && Priced){
+        if (!WithinBand<S>(order.GetPrice()))
+            return OrderResult::RiskRejected;
+    }
+
+    if constexpr (Risk::CheckOwnerCredit && Priced){
+        if (!WithinCredit(order.GetOwner(), 0, Notional(order.GetPrice(), order.GetInitialQuantity())))
+            return OrderResult::RiskRejected;
+    }
+    return OrderResult::Ok;
+}
+
+OrderResult OrderBook::CheckAmend(const Order& order, const OrderModify& modify) const {
+    if constexpr (Risk::CheckMaxQuantity){
+        if (modify.GetQuantity() > riskLimits_.maxOrderQuantity_)
+            return OrderResult::RiskRejected;
+    }
+
+    // only a new price (or side) is checked against the band: an order the market moved away from can still be reduced.
+    if constexpr (Risk::CheckPriceBand){
+        if (modify.GetSide() != order.GetSide() || modify.GetPrice() != order.GetPrice()){
+            const bool within = modify.GetSide() == Side::Buy ? WithinBand<Side::Buy>(modify.GetPrice()) : WithinBand<Side::Sell>(modify.GetPrice());
+            if (!within)
+                return OrderResult::RiskRejected;
+        }
+    }
+
+    if constexpr (Risk::CheckOwnerCredit){
+        Order amended = order;
+        amended.Amend(modify.GetSide(), modify.GetPrice(), modify.GetQuantity());
+        const std::uint64_t released = Notional(order.GetPrice(), order.GetInitialQuantity());
+        if (!WithinCredit(order.GetOwner(), released, Notional(amended.GetPrice(), amended.GetInitialQuantity())))
+            return OrderResult::RiskRejected;
+    }
+    return OrderResult::Ok;
+}
+
+template <Side S>
+bool OrderBook::WithinBand(Price price) const {
+    const auto& opposite = Levels<Opposite<S>>();
+    if (opposite.empty()) return true;  // nothing to measure it against
+
+    const std::int64_t best = opposite.BestPrice();
+    return S == Side::Buy ? price <= best + riskLimits_.priceBand_ : price >= best - riskLimits_.priceBand_;
+}
+
+bool OrderBook::WithinCredit(OwnerId owner, std::uint64_t released, std::uint64_t charged) const {
+    if (owner == NoOwner) return true;
+
+    const auto entry = owners_.find(owner);
+    const std::uint64_t exposure = entry == owners_.end() ? 0 : entry->second.exposure_ - released;
+    return charged <= riskLimits_.ownerCredit_ && exposure <= riskLimits_.ownerCredit_ - charged;
+}
+
+bool OrderBook::PreventSelfTrade(Side aggressor, PriceLevel& bidLevel, OrderHandle bid, PriceLevel& askLevel, OrderHandle ask){
+    // the aggressor's entry first: an order without owner (NoOwner) never self-trades, the resting one is not looked at then.
+    const OwnerId owner = orderPool_.Ownership(aggressor == Side::Buy ? bid : ask).owner_;
+    if (owner == NoOwner || owner != orderPool_.Ownership(aggressor == Side::Buy ? ask : bid).owner_) return false;
+
+    const bool cancelBid = aggressor == Side::Buy ? Risk::CancelsNewest : Risk::CancelsOldest;
+    const bool cancelAsk = aggressor == Side::Sell ? Risk::CancelsNewest : Risk::CancelsOldest;
+    if (cancelBid) CancelAtLevel(bidLevel, bid);
+    if (cancelAsk) CancelAtLevel(askLevel, ask);
+    return true;
+}
 
-        // if the quantity to be filled can be filled with the quantity at the current priceLevel, then just return true
-        if (quantity <= levelData.quantity_)
+void OrderBook::CancelAtLevel(PriceLevel& level, OrderHandle handle){
+    // UnlinkOrder() + CancelOrderInternals(), except for erasing the level: the match loop still holds a reference to it.
+    OnOrderCancelled(level, handle);
+    orderPool_.Erase(level.orders_, handle);
+    orders_.Erase(orderPool_.Hot(handle).orderId_);
+    ForgetOwner(handle);
+    orderPool_.Release(handle);
+}
+
+std::uint64_t OrderBook::GetQuantityUpTo(Side side, Price limit) const {
+    auto ordersLock = LockOrders();
+    constexpr auto everything = std::numeric_limits<std::uint64_t>::max();
+    return side == Side::Buy
+        ? bids_.QuantityUpTo(limit, everything, LevelQuantity)
+        : asks_.QuantityUpTo(limit, everything, LevelQuantity);
+}
+
+OrderResult OrderBook::CancelOrder(OrderId orderId){
+    Instrumentation::ScopedProbe probe{ Instrumentation::Probe::CancelOrder };
+    auto ordersLock = LockOrders();
+
+    JournalCommand(OrderCommand::Cancel(orderId));
+    const OrderResult result = CancelOrderInternals(orderId);
+    PublishTopOfBook();
+    return result;
+}
+
+bool OrderBook::CommitJournal(){
+    auto ordersLock = LockOrders();
+
+    return journal_ == nullptr || journal_->Commit();
+}
+
+bool OrderBook::WriteSnapshot(const std::string& path){
+    SnapshotImage image;
+    return
+        CaptureSnapshot(image) &&
+        (!journal_ || journal_->WaitCommitted(image.header_.journalSequence_)) &&
+        WriteSnapshot(path, image);
+}
+
+bool OrderBook::CaptureSnapshot(SnapshotImage& image){
+    auto& header = image.header_;
+    auto& orders = image.orders_;
+    header = SnapshotHeader{ SnapshotFormat::Magic, SnapshotFormat::Version, 0, symbol_, 0, 0 };
+    orders.clear();
+
+    {
+        auto ordersLock = LockOrders();
+
+        // hand the journal up to here to its writer, without waiting: the image is written out once that is on disk.
+        if (journal_ && !journal_->Commit()) return false;
+        header.journalSequence_ = journal_ ? journal_->NextSequence() : 0;
+        if (inAuction_) header.flags_ |= SnapshotFormat::AuctionFlag;
+
+        orders.reserve(orders_.size() + stops_.size());
+        auto CopyLevel = [&](Price, const PriceLevel& level){
+            for (OrderHandle handle = orderPool_.Front(level.orders_); handle != InvalidOrderHandle; handle = orderPool_.Next(level.orders_, handle)){
+                const auto& hot = orderPool_.Hot(handle);
+                const auto& cold = orderPool_.Cold(handle);
+                const auto& iceberg = orderPool_.Iceberg(handle);
+                SnapshotOrder snapshot;
+                snapshot.orderId_ = hot.orderId_;
+                snapshot.expiry_ = ToEpochNanoseconds(cold.expiry_);
+                snapshot.price_ = cold.price_;
+                snapshot.initialQuantity_ = cold.initialQuantity_;
+                snapshot.remainingQuantity_ = hot.remainingQuantity_ + iceberg.hidden_;
+                snapshot.displayQuantity_ = iceberg.display_;
+                snapshot.visibleQuantity_ = hot.remainingQuantity_;
+                snapshot.orderType_ = static_cast<std::uint8_t>(cold.orderType_);
+                snapshot.side_ = static_cast<std::uint8_t>(cold.side_);
+                snapshot.owner_ = orderPool_.Ownership(handle).owner_;
+                orders.push_back(snapshot);
+            }
             return true;
+        };
+        bids_.ForEach(CopyLevel);
+        asks_.ForEach(CopyLevel);
+
+        stops_.ForEach([&](const Order& order){
+            SnapshotOrder snapshot;
+            snapshot.orderId_ = order.GetOrderId();
+            snapshot.expiry_ = ToEpochNanoseconds(order.GetExpiry());
+            snapshot.price_ = order.GetPrice();
+            snapshot.initialQuantity_ = order.GetInitialQuantity();
+            snapshot.remainingQuantity_ = order.GetRemainingQuantity();
+            snapshot.orderType_ = static_cast<std::uint8_t>(order.GetOrderType());
+            snapshot.side_ = static_cast<std::uint8_t>(order.GetSide());
+            snapshot.owner_ = order.GetOwner();
+            snapshot.stopPrice_ = order.GetStopPrice();
+            orders.push_back(snapshot);
+        });
+    }
+    header.orderCount_ = orders.size();
+    return true;
+}
+
+bool OrderBook::WriteSnapshot(const std::string& path, const SnapshotImage& image){
+    const auto& header = image.header_;
+    const auto& orders = image.orders_;
+
+    // write next to the old one and rename over it -> a crash mid-write leaves the previous snapshot intact.
+    const std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) return false;
+
+    const bool written =
+        std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (orders.empty() || std::fwrite(orders.data(), sizeof(SnapshotOrder), orders.size(), file) == orders.size()) &&
+        std::fflush(file) == 0 &&
+        fsync(fileno(file)) == 0;
+
+    if (std::fclose(file) != 0 || !written || std::rename(temporary.c_str(), path.c_str()) != 0){
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool OrderBook::Recover(const std::string& snapshotPath){
+    auto ordersLock = LockOrders();
+
+    if (!orders_.empty() || !stops_.empty()) return false;
 
-        // if the quantity on the given levelPrice is not enough, then just get the difference.
-        quantity -= levelData.quantity_;
+    std::uint64_t journalSequence = 0;
+    if (!snapshotPath.empty() && !RestoreSnapshot(snapshotPath, journalSequence)) return false;
+
+    if (journal_){
+        // the fills were reported the first time round, and the commands are in the journal already -> apply only.
+        auto DiscardTrade = [](const Trade&){};
+        journal_->Replay(journalSequence, [&](const OrderCommand& command){
+            ApplyInternals(command, DiscardTrade);
+            ReleaseStops(DiscardTrade);  // exactly as the first time round -> the same stops trigger at the same point
+        });
     }
 
-    return false;
+    PublishTopOfBook();
+    return true;
 }
 
-void OrderBook::CancelOrder(OrderId orderId){
-    std::scoped_lock ordersLock{ orderMutex_ };
+bool OrderBook::RestoreSnapshot(const std::string& path, std::uint64_t& journalSequence){
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return errno == ENOENT;  // no snapshot yet -> everything comes from the journal
+
+    struct stat info{};
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(SnapshotHeader)){
+        mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    const auto bytes = static_cast<std::size_t>(info.st_size);
+    const auto& header = *static_cast<const SnapshotHeader*>(mapping);
+    if (
+        header.magic_ != SnapshotFormat::Magic ||
+        header.version_ != SnapshotFormat::Version ||
+        header.symbol_ != symbol_ ||
+        header.orderCount_ > (bytes - sizeof(SnapshotHeader)) / sizeof(SnapshotOrder)
+    ){
+        munmap(mapping, bytes);
+        return false;
+    }
 
-    CancelOrderInternals(orderId);
+    // ! one bad record fails the whole restore, checked before anything is loaded -> never a silently wrong book.
+    const auto* records = reinterpret_cast<const SnapshotOrder*>(static_cast<const char*>(mapping) + sizeof(SnapshotHeader));
+    for (std::uint64_t i = 0; i < header.orderCount_; ++i){
+        if (!SnapshotFormat::ValidOrder(records[i])){
+            munmap(mapping, bytes);
+            return false;
+        }
+    }
+
+    orderPool_.Reserve(header.orderCount_);
+    orders_.Reserve(header.orderCount_);
+
+    // the orders come in level and time priority -> each one goes straight to the back of its level, nothing to match.
+    for (std::uint64_t i = 0; i < header.orderCount_; ++i){
+        const SnapshotOrder& snapshot = records[i];
+        if (orders_.Contains(snapshot.orderId_) || stops_.Contains(snapshot.orderId_)) continue;
+
+        Order order{
+            static_cast<OrderType>(snapshot.orderType_), snapshot.orderId_,
+            static_cast<Side>(snapshot.side_), snapshot.price_, snapshot.initialQuantity_
+        };
+        order.Fill(snapshot.initialQuantity_ - snapshot.remainingQuantity_);
+        order.SetExpiry(FromEpochNanoseconds(snapshot.expiry_));
+        order.SetOwner(snapshot.owner_);
+
+        // pending stops (the last ones in the file) go back to waiting for their trigger.
+        if (order.GetOrderType() == OrderType::Stop || order.GetOrderType() == OrderType::StopLimit){
+            order.SetStopPrice(snapshot.stopPrice_);
+            stops_.Add(order);
+            continue;
+        }
+
+        // an iceberg comes back with the slice it was showing, not a fresh one -> the replay that follows sees the same queue.
+        order.SetDisplayQuantity(snapshot.displayQuantity_);
+        const OrderHandle handle = orderPool_.Allocate(order);
+        if (snapshot.displayQuantity_ != 0 && snapshot.visibleQuantity_ != 0 && snapshot.visibleQuantity_ <= snapshot.remainingQuantity_){
+            orderPool_.Hot(handle).remainingQuantity_ = snapshot.visibleQuantity_;
+            orderPool_.Iceberg(handle).hidden_ = snapshot.remainingQuantity_ - snapshot.visibleQuantity_;
+        }
+        LinkOrder(handle);
+        orders_.Insert(order.GetOrderId(), handle);
+        RememberOwner(handle);
+
+        if (order.GetExpiry() != NoExpiry){
+            expiries_.Schedule(order.GetOrderId(), order.GetExpiry());
+        }
+    }
+
+    // a crossed book only comes from an auction, and stays in it: the replay that follows (or an Uncross()) ends it.
+    inAuction_ = (header.flags_ & SnapshotFormat::AuctionFlag) != 0;
+    journalSequence = header.journalSequence_;
+    munmap(mapping, bytes);
+    return true;
 }
+
+// ! every pair the gateway can dispatch to -> the template itself stays out of the header.
+#define ORDERBOOK_INSTANTIATE_ADD_ORDER(type) \
+    template OrderResult OrderBook::AddOrder<Side::Buy, OrderType::type>(const Order&, TradeSink); \
+    template OrderResult OrderBook::AddOrder<Side::Sell, OrderType::type>(const Order&, TradeSink);
+
+ORDERBOOK_INSTANTIATE_ADD_ORDER(GoodTillCancel)
+ORDERBOOK_INSTANTIATE_ADD_ORDER(FillAndKill)
+ORDERBOOK_INSTANTIATE_ADD_ORDER(FillOrKill)
+ORDERBOOK_INSTANTIATE_ADD_ORDER(GoodForDay)
+ORDERBOOK_INSTANTIATE_ADD_ORDER(Market)
+ORDERBOOK_INSTANTIATE_ADD_ORDER(GoodTillDate)
+ORDERBOOK_INSTANTIATE_ADD_ORDER(Stop)
+ORDERBOOK_INSTANTIATE_ADD_ORDER(StopLimit)
+#undef ORDERBOOK_INSTANTIATE_ADD_ORDER
@@ -1,20 +1,46 @@
 #pragma once
+#include <algorithm>  // for std::min, std::max
+#include <limits>
 #include <map>
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <functional> // for std::less, std::greater
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <span>
+#include <chrono>
+#include <string>
 
 #include "Types.h"
 #include "Order.h"
+#include "OrderPool.h"
+#include "OrderIndex.h"
+#include "ExpiryWheel.h"
+#include "StopBook.h"
+#include "PriceLadder.h"
 #include "OrderModify.h"
+#include "OrderCommand.h"
 #include "Trade.h"
+#include "TradeSink.h"
 #include "OrderBookLevelInfos.h"
+#include "TopOfBook.h"
+#include "AuctionInfo.h"
+#include "SeqLock.h"
+#include "OrderBookConfig.h"
+#include "RiskPolicy.h"
+#include "MarketDataRing.h"
+#include "Journal.h"
+#include "Snapshot.h"
+#include "Instrumentation.h"
 #include <thread>
 
 class OrderBook{
 public:
     OrderBook();  // Default Constructor
+    explicit OrderBook(const OrderBookConfig& config);
 
     // explicitly telling the compiler to preven
     // Prevents creating a new book from an old one: OrderBook b2 = b1; will fail to compile
@@ -32,46 +58,169 @@ public:
     ~OrderBook();  // Destructor
 
     // Main public API of the class
+    // The book keeps its own copy of the order in the order pool,
+    // so the caller does not need to heap-allocate (or keep alive) the order it submits.
+    Trades AddOrder(const Order& order);
     Trades AddOrder(OrderPointer order);
-    void CancelOrder(OrderId orderId);
+    OrderResult CancelOrder(OrderId orderId);  // UnknownOrderId if it is not resting
+    /*
+     * Amend a resting order, atomically:
+        * same side and price, quantity down -> updated in place, it keeps its place in the queue
+        * anything else (price or side change, quantity up) -> moved to the back of its new level, in the same pool slot
+        * quantity 0 -> cancelled
+     */
     Trades ModifyOrder(OrderModify order);
 
-    std::size_t Size() const;
+    // Dispatch a flat command (as queued by the Sequencer / BookManager) to AddOrder, CancelOrder or ModifyOrder.
+    // A Cancel or Modify carrying an owner (e.g., the session it came in on) only applies to that owner's orders, NotOwner otherwise.
+    Trades Apply(const OrderCommand& command);
+
+    /*
+     * Same calls, but every fill is handed to the sink the moment it happens instead of being collected
+     * into a Trades vector -> nothing on the matching path allocates, e.g.:
+        * book.AddOrder(order, [&](const Trade& trade){ ring.TryPush(trade); });
+     * They also report what became of the command (OrderResult): a rejected one leaves the book as it was.
+     */
+    OrderResult AddOrder(const Order& order, TradeSink onTrade);
+    OrderResult ModifyOrder(const OrderModify& order, TradeSink onTrade);
+    OrderResult Apply(const OrderCommand& command, TradeSink onTrade);
+
+    /*
+     * AddOrder() for a caller that already knows the side and type of the order, e.g., a gateway decoding them off the wire:
+     * the side (which ladder it rests on, which one it matches against) and the type policy (Market, FAK, FOK, expiry)
+     * are resolved at compile time -> no branch on either on the way in.
+        * book.AddOrder<Side::Buy, OrderType::FillAndKill>(order, sink);
+     * order.GetSide() and order.GetOrderType() must be S and T, Malformed otherwise. Instantiated in OrderBook.cpp for every pair.
+     */
+    template <Side S, OrderType T>
+    OrderResult AddOrder(const Order& order, TradeSink onTrade);
+
+    /*
+     * Batch entry points: the whole batch is applied in sequence under a single lock acquisition,
+     * and the trades of every command are appended to the caller's buffer (which can be reused between batches).
+     */
+    void AddOrders(std::span<const Order> orders, Trades& trades);
+    void CancelOrders(std::span<const OrderId> orderIds);
+    void ProcessBatch(std::span<const OrderCommand> commands, Trades& trades);
+    void ProcessBatch(std::span<const OrderCommand> commands, TradeSink onTrade);
+
+    /*
+     * Mass cancels, each in one critical section and at a cost proportional to the orders cancelled:
+        * CancelOwnerOrders() -> every order of an owner (Order::SetOwner()), e.g., when its session drops, pending stops included
+        * CancelSide() -> every resting order of one side
+        * CancelPriceRange() -> every resting order of one side priced within [low, high]
+     * Every cancelled order is journaled as a Cancel of its own. They return the number of orders cancelled.
+     */
+    std::size_t CancelOwnerOrders(OwnerId owner);
+    std::size_t CancelSide(Side side);
+    std::size_t CancelPriceRange(Side side, Price low, Price high);
+
+    /*
+     * Call auction, e.g., for the open and the close:
+        * BeginAuction() -> from now on orders rest without matching, crossing or not; Market, FAK and FOK orders are
+          rejected (NotExecuted), there is nothing to trade against before the uncross.
+        * GetAuctionInfo() -> the indicative uncross (price, volume, surplus) if Uncross() were called now.
+        * Uncross() -> trade out everything that crosses at that one price (both sides of every fill get it), in price-time
+          priority and in one batch, then back to continuous trading. NotExecuted outside an auction.
+     * Both are journaled (CommandType::BeginAuction / Uncross) -> a replay goes through the same phases.
+     */
+    void BeginAuction();
+    Trades Uncross();
+    OrderResult Uncross(TradeSink onTrade);
+    AuctionInfo GetAuctionInfo() const;
+    bool InAuction() const;
+
+    std::size_t Size() const;  // resting orders, the pending stops are not in the book yet
+    std::size_t PendingStops() const;
     OrderBookLevelInfos GetOrderInfos() const;
 
+    // Top-of-book depth for one side: write the best levels.size() levels (best first) into the caller's buffer.
+    // Reads the per-level totals the book maintains, so it is O(levels written) and does not allocate.
+    // Returns the number of levels written, which is less than levels.size() if the side is shallower.
+    std::size_t GetDepth(Side side, std::span<LevelInfo> levels) const;
+
+    // Total quantity resting on one side at `limit` or better (icebergs' reserves included), e.g., what a limit order at that price could take at most.
+    std::uint64_t GetQuantityUpTo(Side side, Price limit) const;
+
+    /*
+     * The best TopOfBook::Depth levels of both sides, as of the end of the last call that changed them.
+     * ! Lock-free, from any thread: a copy out of a seqlock the book republishes under its own lock -> it never waits for
+     * ! (nor slows down) the matching, e.g., for market-data or risk threads polling the top of the book.
+     */
+    TopOfBook GetTopOfBook() const { return topOfBook_.Load(); }
+
+    /*
+     * Cancel the orders whose expiry has passed at `now` (GoodTillDate expiry, GoodForDay cutoff),
+     * at most OrderBookConfig::expiryChunk_ of them per call -> the book is never held for longer than one chunk.
+     * Returns true once nothing due is left, false if it should be called again.
+     * Run by the prune thread every expiry tick; the owner of a single-writer book calls it from its own thread instead.
+     * The latest `now` is the book's time: a GoodTillDate order already due by then is rejected (Malformed) on arrival.
+     */
+    bool ExpireOrders(Timestamp now);
+
+    /*
+     * Persistence (needs OrderBookConfig::journal_ for anything but a bare snapshot):
+        * CommitJournal() -> hand the journal records appended so far to its writer thread (a group commit), without waiting
+          for the disk; the owner calls it when idle and every now and then under load.
+        * WriteSnapshot() -> commit the journal, then write every resting order to `path` (atomically replaced).
+          Only the copy is taken under the lock; the wait for the journal and the file write come after it is released.
+        * CaptureSnapshot() + WriteSnapshot(path, image) -> the same in two steps, e.g., the copy on the matching thread
+          and the (slow) write on a housekeeping one.
+          ! The image must not be written before the journal is on disk up to image.header_.journalSequence_
+          ! (Journal::WaitCommitted()): a restart would otherwise skip the records appended after the snapshot.
+        * Recover() -> into an empty book: load the snapshot (if the file exists), then replay the journal records after it.
+     * All of them return false on an I/O error or a bad snapshot.
+     */
+    bool CommitJournal();
+    bool WriteSnapshot(const std::string& path);
+    bool CaptureSnapshot(SnapshotImage& image);
+    static bool WriteSnapshot(const std::string& path, const SnapshotImage& image);
+    bool Recover(const std::string& snapshotPath);
+
+    // The next GoodForDay cutoff (16:00 local time) strictly after the given time point.
+    static std::chrono::system_clock::time_point NextGoodForDayCutoff(std::chrono::system_clock::time_point now);
+
 private:
     // List or Vectors ->
     // Maps or Unordered Maps -> bids and asks
-    struct OrderEntry{
-        OrderPointer order_ { nullptr };
-        OrderPointers::iterator location_;
-    };
-
     struct LevelData{
         /*
          * This is for book-keeping
 
          * Data at each price level
-         * It is used for data_: Price to LevelData
+         * Kept inside the PriceLevel itself, and updated on every add, cancel and fill
+         * -> the depth of a level can be read without walking its orders.
          */
-        Quantity quantity_{};
-        Quantity count_{};
+        Quantity quantity_{};  // total remaining quantity resting at the level, as displayed: icebergs count with their shown slice only
+        Quantity count_{};  // number of orders resting at the level
+        Quantity hidden_{};  // reserves of the icebergs resting here: not displayed, but a sweep still takes them as they show
+        bool hasIcebergs_{};  // set once an iceberg rests here, cleared with the level -> other levels' fills never look at OrderIceberg
 
         enum class Action{
             Add,
             Remove,
             Match,
+            Replenish,  // an iceberg shows its next slice: quantity up, same order count
         };
     };
 
-    // ! This is the data structure for Action at each price point.
-    std::unordered_map<Price, LevelData> data_;
+    struct PriceLevel{
+        LevelQueue orders_;  // an intrusive list, or a ring of handles with ORDERBOOK_RING_LEVELS (see OrderPool.h)
+        LevelData data_;
+    };
 
-    // ! Sell -> asks_.begin() should be the the first greater price than the market price -> ascending
-    std::map<Price, OrderPointers, std::less<Price>> asks_;
+    // ! Every resting order lives in this arena; the price levels only chain handles to the slots together.
+    OrderPool orderPool_;
 
-    // ! Buy -> bids_.begin() should be the first less price than the market price -> descending
-    std::map<Price, OrderPointers, std::greater<Price>> bids_;
+    // ! Recycles the map nodes of asks_, bids_ and owners_ -> once warm, adding a level does not hit the heap.
+    // Declared before the containers using it, so it outlives them.
+    std::pmr::unsynchronized_pool_resource nodeResource_;
+
+    // ! Sell -> asks_.Best() should be the the first greater price than the market price -> ascending
+    PriceLadder<PriceLevel, Side::Sell> asks_;
+
+    // ! Buy -> bids_.Best() should be the first less price than the market price -> descending
+    PriceLadder<PriceLevel, Side::Buy> bids_;
 
     /*
      * Synchronization Method + Thread
@@ -82,6 +231,17 @@ private:
     // we need to protect the data structure with lock, i.e., race condition
     mutable std::mutex orderMutex_;
 
+    // Set from OrderBookConfig::singleWriter_: the book is only ever touched by one thread, so orderMutex_ is never taken.
+    const bool singleWriter_;
+
+    // Lock orderMutex_, unless the book is single-writer -> then the returned lock is empty.
+    std::unique_lock<std::mutex> LockOrders() const;
+
+    // Sink appending to a Trades vector, for the Trades-returning overloads.
+    static auto AppendTo(Trades& trades){
+        return [&trades](const Trade& trade){ trades.push_back(trade); };
+    }
+
     // A separate Os-level thread of execution
     // Used for a backgroudn loop that asynchronously removes expired, canceld or fully fille dorders.
     // cancel the GTD order at the end of the day.
@@ -94,20 +254,195 @@ private:
     // The main thread sets this to `true` when the application is closing, and the background thread checks it to know when to exit its loop safely.
     std::atomic<bool> shutdown_{ false };
 
-    std::unordered_map<OrderId, OrderEntry> orders_;
+    // owner -> its resting orders, chained through the pool's OrderOwnership links. Only owners with orders in the book.
+    struct OwnerOrders{
+        OrderList orders_;
+        std::uint64_t exposure_{};  // notional of orders_ at their full size, counted against RiskLimits::ownerCredit_ (OwnerCredit only)
+    };
+    std::pmr::unordered_map<OwnerId, OwnerOrders> owners_{ &nodeResource_ };
+    std::vector<OrderId> massCancelIds_;  // scratch buffer of CancelPriceRange(): the levels are not walked while they change
+
+    /*
+     * Stop and StopLimit orders: held in stops_ (not in the levels, nor in orders_) until a trade prints through their stop price.
+     * MatchOrders() / SweepOrders() note the range of the prices they print at; at the end of every command the public entry points
+     * call ReleaseStops(), which hands the stops that range triggers to AddOrderInternals() as the orders they were waiting to be,
+     * in one batch, then does the same for whatever those trades trigger in turn.
+     * ! Only trades after a stop came in trigger it, even if the market is already beyond its stop price:
+     * ! the trigger depends on the commands alone, so a journal replay triggers the same stops at the same point.
+     */
+    StopBook stops_{ &nodeResource_ };
+    std::vector<Order> triggeredStops_;  // scratch buffer of ReleaseTriggeredStops()
+    Price printLow_{ std::numeric_limits<Price>::max() };  // lowest / highest trade price since the last ReleaseStops(), low > high if none
+    Price printHigh_{ std::numeric_limits<Price>::min() };
+
+    void NotePrint(Price price){
+        printLow_ = std::min(printLow_, price);
+        printHigh_ = std::max(printHigh_, price);
+    }
+    void ReleaseStops(TradeSink onTrade){
+        if (printLow_ <= printHigh_) ReleaseTriggeredStops(onTrade);
+    }
+    void ReleaseTriggeredStops(TradeSink onTrade);
+
+    /*
+     * Call auction: while inAuction_ is set, AddOrderInternals() and ModifyOrderInternals() link orders without matching them,
+     * so the book can stay crossed until UncrossInternals() trades it out.
+     * The equilibrium is one pass over the crossing levels of both sides (ComputeUncross()), the best of the price
+     * candidates by executed volume, then by the smallest surplus.
+     */
+    bool inAuction_{ false };
+    struct AuctionLevel{
+        Price price_{};
+        std::uint64_t quantity_{};  // reserves included
+    };
+    mutable std::vector<AuctionLevel> auctionBids_;  // scratch buffers of ComputeUncross(), the crossing levels best first
+    mutable std::vector<AuctionLevel> auctionAsks_;
+
+    AuctionInfo ComputeUncross() const;
+    static std::uint64_t AuctionQuantity(const PriceLevel& level) { return LevelQuantity(level); }  // icebergs' reserves included
+    void UncrossOrders(const AuctionInfo& uncross, TradeSink onTrade);  // MatchOrders(), every fill at uncross.price_
+
+    /*
+     * Pre-trade checks and self-trade prevention: which ones run is BookRiskPolicy (compile time), their limits riskLimits_.
+        * CheckPreTrade() / CheckAmend() -> at the top of AddOrderInternals() / ModifyOrderInternals(), before anything changes
+        * PreventSelfTrade() -> in MatchOrders() and UncrossOrders() for every pair about to trade, SweepOrders() does the same inline
+     * ! Self-trade prevention cancels orders by itself (not journaled, like the FAK cleanup): a replay cancels the same ones.
+     */
+    using Risk = BookRiskPolicy;
+    const RiskLimits riskLimits_;
+
+    template <Side S, OrderType T> OrderResult CheckPreTrade(const Order& order) const;
+    OrderResult CheckAmend(const Order& order, const OrderModify& modify) const;
+    template <Side S> bool WithinBand(Price price) const;
+    // would the owner still be within its credit with `released` notional less and `charged` more?
+    bool WithinCredit(OwnerId owner, std::uint64_t released, std::uint64_t charged) const;
+    static std::uint64_t Notional(Price price, Quantity quantity){
+        return price > 0 ? static_cast<std::uint64_t>(price) * quantity : 0;
+    }
+    void ChargeCredit(OrderHandle handle, bool refund);  // ModifyOrderInternals(): around an amend of an order staying on its owner's list
+
+    // The fronts of the two levels have the same owner -> cancel the one(s) the policy says and return true, false if not a self-trade.
+    // aggressor: side of the newest order of the two (the surplus side in an uncross, where neither is).
+    bool PreventSelfTrade(Side aggressor, PriceLevel& bidLevel, OrderHandle bid, PriceLevel& askLevel, OrderHandle ask);
+    // Take an order off its level in the middle of a match: the caller erases the level once it is empty.
+    void CancelAtLevel(PriceLevel& level, OrderHandle handle);
+    // FOK with self-trade prevention: the fill must be covered without meeting an order of its own owner it would be cancelled by.
+    template <Side S> bool CanFullyFillWithoutSelfTrade(const Order& order) const;
+
+    // ID -> slot of the order in orderPool_ (also its position in the level's list). Flat, sized from expectedOrders_ upfront.
+    OrderIndex orders_;
+
+    // ! filled at AddOrder time, drained by ExpireOrders() -> expiry never scans orders_.
+    ExpiryWheel expiries_;
+    std::vector<ExpiryWheel::Entry> dueExpiries_;  // scratch buffer of ExpireOrders(), one chunk at most
+    const std::size_t expiryChunk_;
+    const std::chrono::nanoseconds expiryTick_;
+    const int pruneCpu_;  // core of ordersPruneThread_
+    Timestamp goodForDayCutoff_;  // expiry given to every GoodForDay order added before it, moved on by ExpireOrders()
+    Timestamp expiredUpTo_{ Timestamp::min() };  // the book's time: the latest `now` given to ExpireOrders()
+
+    /*
+     * A GoodTillDate order due at or before the book's time would rest already dead -> rejected (Malformed) on the way in.
+     * ! Checked by the public entry points before the command is journaled: the book's time is not in the journal,
+     * ! so a replay must not see the command at all. (A GoodTillDate order without a date is rejected by AddOrderInternals().)
+     */
+    bool ExpiresOnArrival(OrderType type, Timestamp expiry) const {
+        return type == OrderType::GoodTillDate && expiry <= expiredUpTo_;
+    }
+
+    // ! published to from UpdateLevelData() and MatchOrders(), i.e., under the same lock as the book itself.
+    MarketDataRing* const marketData_;
+    const SymbolId symbol_;
+
+    // ! appended to by the public entry points only: what the internals do on their own (FAK cleanup, ...) follows from replaying them.
+    Journal* const journal_;
+    void JournalCommand(const OrderCommand& command){
+        if (!journal_) return;
+        // a GoodForDay order goes in with the cutoff AddOrderInternals() gives it -> replayed after the close, it keeps that day's.
+        if (command.type_ == CommandType::Add && command.orderType_ == OrderType::GoodForDay && command.expiry_ == NoExpiry){
+            OrderCommand stamped = command;
+            stamped.expiry_ = goodForDayCutoff_;
+            journal_->Append(stamped);
+            return;
+        }
+        journal_->Append(command);
+    }
+
+    bool RestoreSnapshot(const std::string& path, std::uint64_t& journalSequence);  // expects the lock held and the book empty
+
+    // ! written by whoever holds the book (under orderMutex_), read by anyone -> on cache lines of its own.
+    SeqLock<TopOfBook> topOfBook_;
+    TopOfBook publishedTop_;  // writer-side copy of what topOfBook_ holds, to tell whether a level change shows in it
+    bool bidsTopDirty_{ false };  // set by UpdateLevelData() for a level within publishedTop_ -> only that side is walked again
+    bool asksTopDirty_{ false };
+
+    // Called at the end of every public call that can change the book, before its lock is released.
+    void PublishTopOfBook(){
+        if (bidsTopDirty_ || asksTopDirty_) RepublishTopOfBook();
+    }
+    void RepublishTopOfBook();
+    bool ShowsInTopOfBook(Side side, Price price) const;  // expects the lock held
+
+
+    template <Side S>
+    static constexpr Side Opposite = S == Side::Buy ? Side::Sell : Side::Buy;
+
+    // bids_ for Side::Buy, asks_ for Side::Sell -> picked at compile time.
+    template <Side S> auto& Levels();
+    template <Side S> const auto& Levels() const;
+
+    // ! S: side of the incoming order -> they look at the opposite side of the book.
+    template <Side S> bool CanMatch(Price price) const;  // Getter
+    template <Side S> bool CanFullyFill(Price price, Quantity quantity) const;  // Getter
+
+    // What can trade against a level, icebergs' reserves included -> the ladder's dense copy, and the scans of the levels
+    // stored off its window, count the same (feasibility, not depth: GetDepth() and the feeds show quantity_ alone).
+    static Quantity LevelQuantity(const PriceLevel& level) { return level.data_.quantity_ + level.data_.hidden_; }
+
+    // Aggressor: side of the order that just came in and may cross.
+    // Returns SelfTrade if self-trade prevention cancelled it, Ok otherwise.
+    template <Side Aggressor> OrderResult MatchOrders(TradeSink onTrade);
+    OrderResult MatchOrders(Side aggressor, TradeSink onTrade);
+
+    // Immediate execution (Market, FillAndKill, FillOrKill): the order takes what it can from the opposite side and never rests.
+    // Returns Ok if it filled anything, NotExecuted if not, SelfTrade if self-trade prevention cancelled it.
+    template <Side Aggressor, OrderType T> OrderResult SweepOrders(const Order& order, TradeSink onTrade);
+
+    void PruneExpiredOrders();
+
+    // ! The *Internals expect orderMutex_ to be held already (or the book to be single-writer).
+    OrderResult AddOrderInternals(const Order& order, TradeSink onTrade);  // dispatches on the side and type to the one below
+    template <Side S, OrderType T> OrderResult AddOrderInternals(const Order& order, TradeSink onTrade);
+    OrderResult ModifyOrderInternals(const OrderModify& modify, TradeSink onTrade);
+    OrderResult ApplyInternals(const OrderCommand& command, TradeSink onTrade);
+    OrderResult CancelOrderInternals(OrderId orderId);
+    OrderResult BeginAuctionInternals();
+    OrderResult UncrossInternals(TradeSink onTrade);
+    template <Side S> std::size_t CancelLevelsInternals(Price from, Price to);  // from: the better end of the range
+
+    // A Cancel / Modify command from `owner` may touch the order: NoOwner checks nothing, an unknown order is left to the internals.
+    bool SentByOwner(OrderId orderId, OwnerId owner) const;
 
+    // Put the order on / take it off the list of its owner (no-op for NoOwner). Every order leaving the book goes through ForgetOwner().
+    void RememberOwner(OrderHandle handle);
+    void ForgetOwner(OrderHandle handle);
 
-    bool CanMatch(Side side, Price price) const;  // Getter
-    bool CanFullyFill(Side side, Price price, Quantity quantity) const;  // Getter
-    Trades MatchOrders();
+    // Put the order in the pool slot at the back of its price level / take it off its level (erasing the level once empty).
+    // The slot itself, and the order's entry in orders_, are left alone -> an amend moves the order without reallocating it.
+    template <Side S> void LinkOrder(OrderHandle handle);
+    void LinkOrder(OrderHandle handle);
+    void UnlinkOrder(OrderHandle handle);
 
-    void PruneGoodForDayOrders();
-    void CancelOrders(OrderIds orderIds);
-    void CancelOrderInternals(OrderId orderId);
+    // The shown slice of an iceberg ran out at the front of its level: is there more held back? (Replenish() shows it if so.)
+    bool HasReserve(const PriceLevel& level, OrderHandle handle) const {
+        return level.data_.hasIcebergs_ && orderPool_.Iceberg(handle).hidden_ != 0;
+    }
+    // Show the next slice and requeue the order at the back of its level: same pool slot, same entry in orders_.
+    void Replenish(PriceLevel& level, Side side, Price price, OrderHandle handle);
 
-    void OnOrderCancelled(OrderPointer order);
-    void OnOrderAdded(OrderPointer order);
-    void OnOrderMatched(Price price, Quantity quantity, bool isFullyFilled);
-    void UpdateLevelData(Price price, Quantity quantity, LevelData::Action action);
+    void OnOrderCancelled(PriceLevel& level, OrderHandle handle);
+    void OnOrderAdded(PriceLevel& level, OrderHandle handle);
+    void OnOrderMatched(PriceLevel& level, Side side, Price price, Quantity quantity, bool isFullyFilled);
+    void UpdateLevelData(PriceLevel& level, Side side, Price price, Quantity quantity, LevelData::Action action);
 
 };
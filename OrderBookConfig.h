@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+#include "Types.h"
+#include "RiskPolicy.h"
+
+class MarketDataRing;
+class Journal;
+
+struct OrderBookConfig{
+    // Number of resting orders to pre-allocate room for (order pool + order index).
+    // Sizing this to the expected peak means the book never has to touch the allocator while trading.
+    std::size_t expectedOrders_{ 0 };
+
+    /*
+     * Price ladder window, shared by both sides of the book.
+     * Levels at basePrice + n * tickSize, for n in [0, ladderLevels_), are kept in a flat array -> O(1) best price,
+     * no allocation on level insert/erase. Anything else (outside the window or off-tick) goes to the ordered map.
+     * ladderLevels_ == 0 keeps the whole book in the map.
+     */
+    Price ladderBasePrice_{ 0 };
+    Price ladderTickSize_{ 1 };
+    std::size_t ladderLevels_{ 0 };
+
+    /*
+     * The book is owned and driven by exactly one thread (e.g., the matching thread of a Sequencer).
+     * Every public call then skips orderMutex_, and no background prune thread is started:
+     * the owner has to call ExpireOrders() every now and then itself.
+     */
+    bool singleWriter_{ false };
+
+    // Core the background prune thread of a locked book is pinned to (e.g., a housekeeping core), -1 leaves it to the scheduler.
+    int pruneCpu_{ -1 };
+
+    /*
+     * Expiry timer wheel (GoodForDay cutoff, GoodTillDate): expiryTick_ is the resolution an order expires at,
+     * expirySlots_ the number of ticks the wheel covers before an expiry waits in the far list.
+     * expiryChunk_ is the most orders one ExpireOrders() call cancels -> bounds how long it holds the book.
+     */
+    std::chrono::nanoseconds expiryTick_{ std::chrono::milliseconds{ 100 } };
+    std::size_t expirySlots_{ 1 << 13 };
+    std::size_t expiryChunk_{ 256 };
+
+    /*
+     * Incremental market data: every level update and trade of the book is published into this ring, tagged with symbol_.
+     * Not owned -> the ring has to outlive the book. A ring has a single publisher, so books sharing one must run on the same thread.
+     * nullptr publishes nothing.
+     */
+    MarketDataRing* marketData_{ nullptr };
+    SymbolId symbol_{ 0 };
+
+    /*
+     * Write-ahead journal: every command the book is given is appended to it, in the order it is applied.
+     * Not owned, like marketData_. With a journal, Recover() can rebuild the book after a restart.
+     */
+    Journal* journal_{ nullptr };
+
+    // Limits of the pre-trade checks the book is built with (BookRiskPolicy, see RiskPolicy.h). Unlimited by default.
+    RiskLimits risk_{};
+};
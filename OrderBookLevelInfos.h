@@ -1,12 +1,15 @@
 #pragma once
+#include <utility>
+
 #include "LevelInfo.h"
 
 class OrderBookLevelInfos{
 public:
+    // taken by value -> the book moves its freshly built vectors in instead of copying them.
     OrderBookLevelInfos(
-        const LevelInfos& bids,
-        const LevelInfos& asks
-    ): bids_{ bids }, asks_{ asks }{}
+        LevelInfos bids,
+        LevelInfos asks
+    ): bids_{ std::move(bids) }, asks_{ std::move(asks) }{}
 
     const LevelInfos& GetBids() const { return bids_; }
     const LevelInfos& GetAsks() const { return asks_; }
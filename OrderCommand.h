@@ -0,0 +1,74 @@
+#pragma once
+#include "Types.h"
+#include "Order.h"
+#include "OrderModify.h"
+
+enum class CommandType{
+    Add,
+    Cancel,
+    Modify,
+    BeginAuction,  // book-wide, no other field used: orders rest without matching until the next Uncross
+    Uncross,  // book-wide: trade out everything that crosses at one price, then back to continuous trading
+};
+
+/*
+ * One request against the book, as a flat value -> it can be copied through a ring buffer (or written to disk) as-is.
+ * Fields a command does not use are left zeroed, e.g., a Cancel only carries orderId_.
+ */
+struct OrderCommand{
+    CommandType type_{ CommandType::Add };
+    OrderType orderType_{ OrderType::GoodTillCancel };
+    OrderId orderId_{};
+    Side side_{ Side::Buy };
+    Price price_{};
+    Quantity quantity_{};
+    Timestamp expiry_{ NoExpiry };  // GoodTillDate only, and GoodForDay as journaled (its cutoff)
+    OwnerId owner_{ NoOwner };  // Add: owner of the new order. Cancel / Modify: who sends it, checked against the order's (NoOwner: not checked)
+    Price stopPrice_{ Constants::InvalidPrice };  // Stop and StopLimit only
+    Quantity displayQuantity_{};  // Add only: iceberg display size, 0 = fully displayed
+
+    static OrderCommand Add(const Order& order){
+        return OrderCommand{
+            CommandType::Add, order.GetOrderType(), order.GetOrderId(),
+            order.GetSide(), order.GetPrice(), order.GetRemainingQuantity(), order.GetExpiry(), order.GetOwner(), order.GetStopPrice(),
+            order.GetDisplayQuantity()
+        };
+    }
+
+    static OrderCommand Cancel(OrderId orderId, OwnerId owner = NoOwner){
+        OrderCommand command;
+        command.type_ = CommandType::Cancel;
+        command.orderId_ = orderId;
+        command.owner_ = owner;
+        return command;
+    }
+
+    static OrderCommand BeginAuction(){
+        OrderCommand command;
+        command.type_ = CommandType::BeginAuction;
+        return command;
+    }
+
+    static OrderCommand Uncross(){
+        OrderCommand command;
+        command.type_ = CommandType::Uncross;
+        return command;
+    }
+
+    static OrderCommand Modify(const OrderModify& modify, OwnerId owner = NoOwner){
+        return OrderCommand{
+            CommandType::Modify, OrderType::GoodTillCancel, modify.GetOrderId(),
+            modify.GetSide(), modify.GetPrice(), modify.GetQuantity(), NoExpiry, owner
+        };
+    }
+
+    Order ToOrder() const {
+        Order order{ orderType_, orderId_, side_, price_, quantity_ };
+        order.SetExpiry(expiry_);
+        order.SetOwner(owner_);
+        order.SetStopPrice(stopPrice_);
+        order.SetDisplayQuantity(displayQuantity_);
+        return order;
+    }
+    OrderModify ToOrderModify() const { return OrderModify{ orderId_, side_, price_, quantity_ }; }
+};
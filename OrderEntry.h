@@ -0,0 +1,109 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+#include "Types.h"
+
+/*
+ * Binary order-entry protocol: fixed-layout, little-endian messages, several of them back to back in one datagram.
+ * Every message starts with an OrderEntryHeader; length_ is the size of the whole message, header included,
+ * so a decoder can step over a message it does not know (from a newer version of the protocol) without parsing it.
+ *
+ * No padding is left to the compiler, so a client in another language can write them from the layout alone.
+ */
+enum class OrderEntryType : std::uint8_t{
+    NewOrder = 'N',
+    Cancel = 'X',
+    Modify = 'M',
+};
+
+struct OrderEntryHeader{
+    std::uint16_t length_{};  // bytes, header included
+    OrderEntryType type_{};
+    std::uint8_t version_{ 1 };
+    std::uint32_t session_{};  // sender's session -> sequencing, and the OwnerId of the orders it adds
+    std::uint64_t sequence_{};  // per session, starting at 1, one per message
+};
+
+struct NewOrderMessage{
+    OrderEntryHeader header_{};
+    SymbolId symbol_{};
+    Price price_{};  // ignored for a Market or Stop order
+    OrderId orderId_{};
+    std::int64_t expiry_{};  // GoodTillDate only: nanoseconds since the epoch, INT64_MAX = NoExpiry
+    Quantity quantity_{};
+    std::uint8_t orderType_{};  // OrderType
+    std::uint8_t side_{};  // Side: 0 = Buy, 1 = Sell
+    std::uint16_t displayQuantity_{};  // iceberg: quantity shown at a time, 0 = all of it
+    Price stopPrice_{};  // Stop and StopLimit only: the trade price that triggers the order
+    std::uint32_t reserved_{};
+};
+
+struct CancelMessage{
+    OrderEntryHeader header_{};
+    SymbolId symbol_{};
+    std::uint32_t reserved_{};
+    OrderId orderId_{};
+};
+
+struct ModifyMessage{
+    OrderEntryHeader header_{};
+    SymbolId symbol_{};
+    Price price_{};
+    OrderId orderId_{};
+    Quantity quantity_{};  // new open quantity, 0 cancels
+    std::uint8_t side_{};
+    std::uint8_t reserved_[3]{};
+};
+
+static_assert(sizeof(OrderEntryHeader) == 16);
+static_assert(sizeof(NewOrderMessage) == 56);
+static_assert(sizeof(CancelMessage) == 32);
+static_assert(sizeof(ModifyMessage) == 40);
+static_assert(std::is_trivially_copyable_v<NewOrderMessage> && std::is_trivially_copyable_v<CancelMessage> && std::is_trivially_copyable_v<ModifyMessage>);
+// ! the wire is little-endian and the messages are read as-is -> a big-endian host would need a byte swap per field.
+static_assert(std::endian::native == std::endian::little, "the order-entry decoder reads the wire layout in place");
+
+namespace OrderEntry{
+    inline constexpr std::size_t MaxMessageSize = sizeof(NewOrderMessage);
+
+    // Client side, e.g., for tests, benchmarks or a simulator: the messages with their header filled in.
+    inline NewOrderMessage NewOrder(std::uint32_t session, std::uint64_t sequence, SymbolId symbol,
+                                    OrderType orderType, OrderId orderId, Side side, Price price, Quantity quantity,
+                                    Timestamp expiry = NoExpiry, std::uint16_t displayQuantity = 0,
+                                    Price stopPrice = Constants::InvalidPrice){
+        NewOrderMessage message;
+        message.header_ = OrderEntryHeader{ sizeof(NewOrderMessage), OrderEntryType::NewOrder, 1, session, sequence };
+        message.symbol_ = symbol;
+        message.price_ = price;
+        message.orderId_ = orderId;
+        message.expiry_ = ToEpochNanoseconds(expiry);
+        message.quantity_ = quantity;
+        message.orderType_ = static_cast<std::uint8_t>(orderType);
+        message.side_ = static_cast<std::uint8_t>(side);
+        message.displayQuantity_ = displayQuantity;
+        message.stopPrice_ = stopPrice;
+        return message;
+    }
+
+    inline CancelMessage Cancel(std::uint32_t session, std::uint64_t sequence, SymbolId symbol, OrderId orderId){
+        CancelMessage message;
+        message.header_ = OrderEntryHeader{ sizeof(CancelMessage), OrderEntryType::Cancel, 1, session, sequence };
+        message.symbol_ = symbol;
+        message.orderId_ = orderId;
+        return message;
+    }
+
+    inline ModifyMessage Modify(std::uint32_t session, std::uint64_t sequence, SymbolId symbol,
+                                OrderId orderId, Side side, Price price, Quantity quantity){
+        ModifyMessage message;
+        message.header_ = OrderEntryHeader{ sizeof(ModifyMessage), OrderEntryType::Modify, 1, session, sequence };
+        message.symbol_ = symbol;
+        message.price_ = price;
+        message.orderId_ = orderId;
+        message.quantity_ = quantity;
+        message.side_ = static_cast<std::uint8_t>(side);
+        return message;
+    }
+}
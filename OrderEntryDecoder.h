@@ -0,0 +1,167 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>  // for std::memcpy
+#include <span>
+#include <vector>
+
+#include "Types.h"
+#include "OrderCommand.h"
+#include "OrderEntry.h"
+
+struct OrderEntryStats{
+    std::uint64_t messages_{};  // decoded and handed on
+    std::uint64_t duplicates_{};  // sequence already seen -> dropped
+    std::uint64_t gaps_{};  // messages missing in front of one that arrived (lost datagrams) -> counted, then skipped over
+    std::uint64_t malformed_{};  // bad length, type, session, sequence or field -> dropped, as is the rest of its buffer if the length is bad
+};
+
+/*
+ * Turns the messages of a receive buffer into book commands, in place: the fields are read straight out of the buffer
+ * into an OrderCommand, without an Order / OrderModify (or anything on the heap) in between.
+ *
+ * Sequencing, per session (header_.session_, dense in [1, maxSessions]):
+    * the expected sequence is 1 at first, then one past the last message accepted
+    * below it -> a duplicate (a resend), dropped
+    * above it -> the missing ones are counted as a gap and the message is accepted: no retransmission at this layer
+    * more than maxGap above it, or UINT64_MAX -> malformed, dropped: one forged or corrupt sequence number would otherwise
+      turn every later message of the session into a duplicate
+ * The session also becomes the OwnerId of the orders it adds -> OrderBook::CancelOwnerOrders() when it drops,
+ * and the owner its cancels and modifies carry -> the book only applies them to the session's own orders.
+ * Session 0 is not a session (it would be NoOwner), its messages count as malformed.
+ *
+ * ! One decoder per receiving thread: the sequence state is not shared.
+ */
+class OrderEntryDecoder{
+public:
+    static constexpr std::uint64_t DefaultMaxGap = 1 << 20;
+
+    explicit OrderEntryDecoder(std::size_t maxSessions, std::uint64_t maxGap = DefaultMaxGap)
+        : nextSequence_(maxSessions + 1, 1)
+        , maxGap_{ maxGap }
+    {}
+
+    /*
+     * Decode every message of the buffer, in order -> handler(SymbolId, const OrderCommand&) for each one accepted.
+     * The buffer holds whole messages only (one datagram, or a stream cut at message boundaries).
+     * Returns the number of commands handed on.
+     */
+    template <typename Handler>
+    std::size_t Decode(std::span<const std::byte> buffer, Handler&& handler){
+        std::size_t handed = 0;
+        const std::byte* cursor = buffer.data();
+        std::size_t left = buffer.size();
+
+        while (left >= sizeof(OrderEntryHeader)){
+            OrderEntryHeader header;
+            std::memcpy(&header, cursor, sizeof(header));
+
+            // a length we cannot trust means we cannot find the next message either -> drop the rest of the buffer.
+            if (header.length_ < sizeof(OrderEntryHeader) || header.length_ > left){
+                ++stats_.malformed_;
+                return handed;
+            }
+
+            SymbolId symbol{};
+            OrderCommand command;
+            if (!ToCommand(header, cursor, symbol, command)){
+                ++stats_.malformed_;
+            } else if (Sequence(header)){
+                ++stats_.messages_;
+                ++handed;
+                handler(symbol, command);
+            }
+
+            cursor += header.length_;
+            left -= header.length_;
+        }
+
+        if (left != 0){
+            ++stats_.malformed_;  // a torn message at the end
+        }
+        return handed;
+    }
+
+    const OrderEntryStats& Stats() const { return stats_; }
+    std::uint64_t NextSequence(std::uint32_t session) const { return session < nextSequence_.size() ? nextSequence_[session] : 0; }
+
+private:
+    template <typename Message>
+    static bool Read(const OrderEntryHeader& header, const std::byte* cursor, Message& message){
+        // ! a longer message of the same type is a newer version with fields appended -> read the ones we know.
+        if (header.length_ < sizeof(Message)) return false;
+        std::memcpy(&message, cursor, sizeof(Message));  // unaligned-safe; compiles to plain loads
+        return true;
+    }
+
+    static bool ValidSide(std::uint8_t side) { return side <= static_cast<std::uint8_t>(Side::Sell); }
+
+    bool ToCommand(const OrderEntryHeader& header, const std::byte* cursor, SymbolId& symbol, OrderCommand& command) const {
+        if (header.session_ == 0 || header.session_ >= nextSequence_.size()) return false;
+
+        switch (header.type_){
+            case OrderEntryType::NewOrder: {
+                NewOrderMessage message;
+                if (!Read(header, cursor, message) || !ValidSide(message.side_)) return false;
+                if (message.orderType_ > static_cast<std::uint8_t>(OrderType::StopLimit)) return false;
+
+                symbol = message.symbol_;
+                command.type_ = CommandType::Add;
+                command.orderType_ = static_cast<OrderType>(message.orderType_);
+                command.orderId_ = message.orderId_;
+                command.side_ = static_cast<Side>(message.side_);
+                const bool unpriced = command.orderType_ == OrderType::Market || command.orderType_ == OrderType::Stop;
+                command.price_ = unpriced ? Constants::InvalidPrice : message.price_;
+                command.quantity_ = message.quantity_;
+                command.expiry_ = command.orderType_ == OrderType::GoodTillDate ? FromEpochNanoseconds(message.expiry_) : NoExpiry;
+                command.owner_ = header.session_;
+                command.displayQuantity_ = message.displayQuantity_;
+                if (command.orderType_ == OrderType::Stop || command.orderType_ == OrderType::StopLimit){
+                    command.stopPrice_ = message.stopPrice_;  // the book rejects a missing one (InvalidPrice)
+                }
+                return true;
+            }
+            case OrderEntryType::Cancel: {
+                CancelMessage message;
+                if (!Read(header, cursor, message)) return false;
+
+                symbol = message.symbol_;
+                command = OrderCommand::Cancel(message.orderId_, header.session_);
+                return true;
+            }
+            case OrderEntryType::Modify: {
+                ModifyMessage message;
+                if (!Read(header, cursor, message) || !ValidSide(message.side_)) return false;
+
+                symbol = message.symbol_;
+                command.type_ = CommandType::Modify;
+                command.orderId_ = message.orderId_;
+                command.side_ = static_cast<Side>(message.side_);
+                command.price_ = message.price_;
+                command.quantity_ = message.quantity_;
+                command.owner_ = header.session_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Sequence(const OrderEntryHeader& header){
+        auto& expected = nextSequence_[header.session_];
+        if (header.sequence_ < expected){
+            ++stats_.duplicates_;
+            return false;
+        }
+        if (header.sequence_ - expected > maxGap_ || header.sequence_ == UINT64_MAX){
+            ++stats_.malformed_;
+            return false;
+        }
+        stats_.gaps_ += header.sequence_ - expected;
+        expected = header.sequence_ + 1;
+        return true;
+    }
+
+    std::vector<std::uint64_t> nextSequence_;  // [session] -> the sequence expected next
+    const std::uint64_t maxGap_;  // furthest a message may jump ahead of the expected sequence
+    OrderEntryStats stats_;
+};
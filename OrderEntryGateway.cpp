@@ -0,0 +1,96 @@
+#include <cerrno>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "OrderEntryGateway.h"
+#include "BookManager.h"
+
+std::unique_ptr<OrderEntryGateway> OrderEntryGateway::Open(const OrderEntryGatewayConfig& config){
+    if (config.batch_ == 0 || config.datagramSize_ < sizeof(OrderEntryHeader)) return nullptr;
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config.port_);
+    if (inet_pton(AF_INET, config.address_.c_str(), &address.sin_addr) != 1) return nullptr;
+
+    const int socket = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socket < 0) return nullptr;
+
+    // best effort: the kernel caps it at net.core.rmem_max
+    setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &config.receiveBuffer_, sizeof(config.receiveBuffer_));
+
+    socklen_t length = sizeof(address);
+    if (
+        bind(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        getsockname(socket, reinterpret_cast<sockaddr*>(&address), &length) != 0
+    ){
+        close(socket);
+        return nullptr;
+    }
+
+    return std::unique_ptr<OrderEntryGateway>{ new OrderEntryGateway{ socket, ntohs(address.sin_port), config } };
+}
+
+OrderEntryGateway::OrderEntryGateway(int socket, std::uint16_t port, const OrderEntryGatewayConfig& config)
+    : socket_{ socket }
+    , port_{ port }
+    , datagramSize_{ config.datagramSize_ }
+    , decoder_{ config.maxSessions_ }
+    , buffers_(config.batch_ * config.datagramSize_)
+    , iovecs_(config.batch_)
+    , headers_(config.batch_)
+{
+    // the datagrams land in fixed slots of buffers_ -> set once, recvmmsg() only updates msg_len and msg_flags.
+    for (std::size_t i = 0; i < config.batch_; ++i){
+        iovecs_[i] = iovec{ buffers_.data() + i * datagramSize_, datagramSize_ };
+        headers_[i] = mmsghdr{};
+        headers_[i].msg_hdr.msg_iov = &iovecs_[i];
+        headers_[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // the most commands one receive batch can carry: every datagram full of the smallest message.
+    commands_.reserve(config.batch_ * (datagramSize_ / sizeof(CancelMessage)));
+}
+
+OrderEntryGateway::~OrderEntryGateway(){
+    close(socket_);
+}
+
+std::size_t OrderEntryGateway::Receive(){
+    const int received = recvmmsg(socket_, headers_.data(), static_cast<unsigned int>(headers_.size()), MSG_DONTWAIT, nullptr);
+    if (received <= 0) return 0;  // EAGAIN: nothing waiting (any other error shows up again on the next call)
+
+    datagrams_ += static_cast<std::uint64_t>(received);
+    for (int i = 0; i < received; ++i){
+        truncated_ += (headers_[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+    return static_cast<std::size_t>(received);
+}
+
+std::span<const std::byte> OrderEntryGateway::Datagram(std::size_t index) const {
+    const auto& header = headers_[index];
+    // ! truncated: longer than datagramSize_ -> its tail is lost, so none of it is trusted.
+    if (header.msg_hdr.msg_flags & MSG_TRUNC) return {};
+    return { buffers_.data() + index * datagramSize_, header.msg_len };
+}
+
+std::size_t OrderEntryGateway::Poll(OrderBook& book, TradeSink onTrade){
+    commands_.clear();
+    const std::size_t commands = Poll([this](SymbolId, const OrderCommand& command){ commands_.push_back(command); });
+    if (commands != 0){
+        book.ProcessBatch(commands_, onTrade);
+    }
+    return commands;
+}
+
+std::size_t OrderEntryGateway::Poll(BookManager& books){
+    return Poll([this, &books](SymbolId symbol, const OrderCommand& command){
+        if (!books.Submit(symbol, command)){
+            ++rejected_;
+        }
+    });
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Types.h"
+#include "OrderBook.h"
+#include "OrderCommand.h"
+#include "OrderEntryDecoder.h"
+#include "TradeSink.h"
+
+class BookManager;
+struct mmsghdr;
+struct iovec;
+
+struct OrderEntryGatewayConfig{
+    std::string address_{ "0.0.0.0" };  // IPv4 address to bind to
+    std::uint16_t port_{ 0 };  // UDP port, 0 = any free one (see Port())
+    std::size_t batch_{ 64 };  // datagrams taken per recvmmsg() call
+    std::size_t datagramSize_{ 2048 };  // largest datagram accepted, bytes; a longer one is truncated and dropped
+    std::size_t maxSessions_{ 1024 };  // session IDs in [1, maxSessions_]
+    int receiveBuffer_{ 4 << 20 };  // SO_RCVBUF, bytes: room for the bursts between two polls
+};
+
+/*
+ * Network ingress of the book: a non-blocking UDP socket drained with recvmmsg(), i.e., up to batch_ datagrams per system call
+ * into buffers allocated once, then decoded in place (OrderEntryDecoder) straight into book commands.
+ *
+ * Poll() is meant to be spun by the thread that owns the book (or the one feeding a BookManager / Sequencer):
+ * one call = one receive batch -> one OrderBook::ProcessBatch(), so a burst costs one system call and one lock at most.
+ * ! Not thread-safe: one thread polls a gateway.
+ */
+class OrderEntryGateway{
+public:
+    // nullptr if the socket cannot be created or bound.
+    static std::unique_ptr<OrderEntryGateway> Open(const OrderEntryGatewayConfig& config);
+
+    OrderEntryGateway(const OrderEntryGateway&) = delete;
+    void operator=(const OrderEntryGateway&) = delete;
+    ~OrderEntryGateway();
+
+    std::uint16_t Port() const { return port_; }
+    const OrderEntryStats& Stats() const { return decoder_.Stats(); }
+    std::uint64_t Datagrams() const { return datagrams_; }
+    std::uint64_t Truncated() const { return truncated_; }  // longer than datagramSize_ -> dropped whole
+
+    /*
+     * One receive batch, without waiting -> handler(SymbolId, const OrderCommand&) for every command, in arrival order.
+     * Returns the number of commands handed on (0 if nothing was waiting).
+     */
+    template <typename Handler>
+    std::size_t Poll(Handler&& handler){
+        const std::size_t datagrams = Receive();
+        std::size_t commands = 0;
+        for (std::size_t i = 0; i < datagrams; ++i){
+            commands += decoder_.Decode(Datagram(i), handler);
+        }
+        return commands;
+    }
+
+    // Single-instrument gateway: the whole receive batch goes to the book in one ProcessBatch() (symbols are not looked at).
+    std::size_t Poll(OrderBook& book, TradeSink onTrade);
+
+    // Every command routed to its symbol's book; the ones BookManager::Submit() refuses are counted in Rejected().
+    std::size_t Poll(BookManager& books);
+    std::uint64_t Rejected() const { return rejected_; }
+
+private:
+    OrderEntryGateway(int socket, std::uint16_t port, const OrderEntryGatewayConfig& config);
+
+    std::size_t Receive();  // one recvmmsg(), returns the number of datagrams received
+    std::span<const std::byte> Datagram(std::size_t index) const;
+
+    const int socket_;
+    const std::uint16_t port_;
+    const std::size_t datagramSize_;
+    OrderEntryDecoder decoder_;
+
+    std::vector<std::byte> buffers_;  // batch_ x datagramSize_
+    std::vector<iovec> iovecs_;
+    std::vector<mmsghdr> headers_;
+    std::vector<OrderCommand> commands_;  // scratch batch of Poll(OrderBook&), reserved for a full receive batch
+    std::uint64_t datagrams_{ 0 };
+    std::uint64_t truncated_{ 0 };
+    std::uint64_t rejected_{ 0 };
+};
@@ -0,0 +1,47 @@
+#include <algorithm> // for std::max
+#include <bit>  // for std::bit_ceil, std::countr_zero
+
+#include "OrderIndex.h"
+
+void OrderIndex::Reserve(std::size_t capacity){
+    const std::size_t slots = std::bit_ceil(std::max(2 * capacity, MinSlots));
+    if (slots > slots_.size()){
+        Rehash(slots);
+    }
+}
+
+OrderHandle OrderIndex::Erase(OrderId orderId){
+    std::size_t hole = Home(orderId);
+    for (std::uint32_t distance = 0; ; ++distance, hole = (hole + 1) & mask_){
+        const Slot& slot = slots_[hole];
+        if (slot.handle_ == InvalidOrderHandle || slot.distance_ < distance) return InvalidOrderHandle;
+        if (slot.orderId_ == orderId) break;
+    }
+
+    const OrderHandle handle = slots_[hole].handle_;
+    --size_;
+
+    // Backward shift: pull the rest of the run one slot closer to home, up to an entry that is home already (or a free slot).
+    for (std::size_t next = (hole + 1) & mask_; slots_[next].handle_ != InvalidOrderHandle && slots_[next].distance_ > 0; next = (next + 1) & mask_){
+        slots_[hole] = slots_[next];
+        --slots_[hole].distance_;
+        hole = next;
+    }
+    slots_[hole] = Slot{};
+    return handle;
+}
+
+void OrderIndex::Rehash(std::size_t slots){
+    std::vector<Slot> old = std::move(slots_);
+
+    slots_.assign(slots, Slot{});
+    mask_ = slots - 1;
+    bits_ = static_cast<unsigned>(std::countr_zero(slots));
+    size_ = 0;
+
+    for (const auto& slot : old){
+        if (slot.handle_ != InvalidOrderHandle){
+            Insert(slot.orderId_, slot.handle_);
+        }
+    }
+}
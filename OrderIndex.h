@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>  // for std::swap
+#include <vector>
+
+#include "Types.h"
+
+/*
+ * OrderId -> OrderHandle, the book's index of its resting orders.
+ *
+ * Open addressing in one flat array of 16-byte slots, with Robin Hood linear probing: an entry never sits further
+ * from its home slot than the entry it displaced. So a lookup stops at the first slot closer to its home than the
+ * probe is, an insert never allocates, and Erase() finds and removes in the same probe -> a cancel costs one lookup.
+ * Deletion shifts the following entries back (no tombstones), so probes stay short however many orders come and go.
+ *
+ * ! The IDs of a session are a monotonic sequence: consecutive IDs go to consecutive slots (each lap around the table
+ * ! at its own offset) -> the orders of the last moments, where most of the traffic is, share a few cache lines,
+ * ! and with the table at most half full they sit in their home slot.
+ * The table grows by doubling; Reserve() upfront for the expected peak and it never rehashes on the order path.
+ */
+class OrderIndex{
+public:
+    OrderIndex() { Rehash(MinSlots); }
+    explicit OrderIndex(std::size_t capacity) { Reserve(capacity); }
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    // Make room for `capacity` entries without any further rehash.
+    void Reserve(std::size_t capacity);
+
+    // Handle of the order, InvalidOrderHandle if it is not in the index.
+    OrderHandle Find(OrderId orderId) const {
+        std::size_t i = Home(orderId);
+        for (std::uint32_t distance = 0; ; ++distance, i = (i + 1) & mask_){
+            const Slot& slot = slots_[i];
+            if (slot.handle_ == InvalidOrderHandle || slot.distance_ < distance) return InvalidOrderHandle;
+            if (slot.orderId_ == orderId) return slot.handle_;
+        }
+    }
+
+    bool Contains(OrderId orderId) const { return Find(orderId) != InvalidOrderHandle; }
+
+    // Returns false (and leaves the index alone) if the ID is there already.
+    bool Insert(OrderId orderId, OrderHandle handle){
+        if (2 * (size_ + 1) > slots_.size()){
+            Rehash(2 * slots_.size());  // ! only when running past what was reserved
+        }
+
+        Slot entry{ orderId, handle, 0 };
+        bool displaced = false;
+        for (std::size_t i = Home(orderId); ; ++entry.distance_, i = (i + 1) & mask_){
+            Slot& slot = slots_[i];
+            if (slot.handle_ == InvalidOrderHandle){
+                slot = entry;
+                ++size_;
+                return true;
+            }
+            // an existing copy of the ID would come before the first slot we take over -> only look until then.
+            if (!displaced && slot.orderId_ == orderId) return false;
+            if (slot.distance_ < entry.distance_){
+                std::swap(slot, entry);  // take the slot of the entry closer to its home, carry that one on
+                displaced = true;
+            }
+        }
+    }
+
+    // Remove the ID and return the handle it mapped to, InvalidOrderHandle if it was not there.
+    OrderHandle Erase(OrderId orderId);
+
+private:
+    struct Slot{
+        OrderId orderId_{};
+        OrderHandle handle_{ InvalidOrderHandle };  // InvalidOrderHandle -> free slot
+        std::uint32_t distance_{};  // from the home slot of orderId_
+    };
+
+    static constexpr std::size_t MinSlots = 16;
+
+    // the low bits of the ID, offset by a scrambled lap number -> a lap of consecutive IDs lands on consecutive slots.
+    std::size_t Home(OrderId orderId) const {
+        const std::uint64_t lap = orderId >> bits_;
+        return static_cast<std::size_t>(orderId + lap * 0x9E3779B97F4A7C15ull) & mask_;
+    }
+
+    void Rehash(std::size_t slots);  // slots: a power of two
+
+    std::vector<Slot> slots_;
+    std::size_t mask_{};
+    unsigned bits_{};  // log2(slots_.size())
+    std::size_t size_{};
+};
@@ -6,8 +6,3 @@ OrderModify::OrderModify(OrderId orderId, Side side, Price price, Quantity quant
     , price_{price}
     , quantity_{quantity}
 {}
-
-OrderPointer OrderModify::ToOrderPointer(OrderType type) const {
-    // to initialize an instance
-    return std::make_shared<Order>(type, GetOrderId(), GetSide(), GetPrice(), GetQuantity());
-}
@@ -1,5 +1,5 @@
 #pragma once
-#include "Order.h"
+#include "Types.h"
 
 class OrderModify{
 public:
@@ -10,8 +10,6 @@ public:
     Price GetPrice() const { return price_; }
     Quantity GetQuantity() const { return quantity_; }
 
-    OrderPointer ToOrderPointer(OrderType type) const;
-
 private:
     OrderId orderId_;
     Side side_;
@@ -0,0 +1,229 @@
+#include "OrderPool.h"
+
+OrderPool::OrderPool(std::size_t capacity){
+    Reserve(capacity);
+}
+
+OrderHandle OrderPool::Allocate(const Order& order){
+    if (freeList_ == InvalidOrderHandle){
+        Grow();
+    }
+
+    const OrderHandle handle = freeList_;
+    auto& hot = Hot(handle);
+    freeList_ = hot.next_;
+
+    Store(handle, order);
+    hot.next_ = InvalidOrderHandle;
+    Cold(handle).prev_ = InvalidOrderHandle;
+    Ownership(handle).prev_ = Ownership(handle).next_ = InvalidOrderHandle;
+    return handle;
+}
+
+void OrderPool::Release(OrderHandle handle){
+    // push the slot back on the free list -> it is handed out again by the next Allocate (LIFO, so it is still warm in cache).
+    Hot(handle).next_ = freeList_;
+    freeList_ = handle;
+}
+
+Order OrderPool::Load(OrderHandle handle) const {
+    const auto& hot = Hot(handle);
+    const auto& cold = Cold(handle);
+
+    const auto& iceberg = Iceberg(handle);
+
+    Order order{ cold.orderType_, hot.orderId_, cold.side_, cold.price_, cold.initialQuantity_ };
+    order.Fill(cold.initialQuantity_ - (hot.remainingQuantity_ + iceberg.hidden_));
+    order.SetDisplayQuantity(iceberg.display_);
+    order.SetExpiry(cold.expiry_);
+    order.SetOwner(Ownership(handle).owner_);
+    return order;
+}
+
+void OrderPool::Store(OrderHandle handle, const Order& order){
+    auto& hot = Hot(handle);
+    auto& cold = Cold(handle);
+
+    hot.orderId_ = order.GetOrderId();
+    hot.remainingQuantity_ = order.GetVisibleQuantity();
+    Iceberg(handle) = OrderIceberg{ order.GetDisplayQuantity(), order.GetHiddenQuantity() };
+    cold.expiry_ = order.GetExpiry();
+    cold.price_ = order.GetPrice();
+    cold.initialQuantity_ = order.GetInitialQuantity();
+    cold.orderType_ = order.GetOrderType();
+    cold.side_ = order.GetSide();
+    Ownership(handle).owner_ = order.GetOwner();
+}
+
+void OrderPool::Reserve(std::size_t capacity){
+    while (Capacity() < capacity){
+        Grow();
+    }
+}
+
+void OrderPool::Grow(){
+    const auto base = static_cast<OrderHandle>(Capacity());
+    auto slab = std::make_unique<OrderSlab>();
+
+    // thread the new slab into the free list, lowest handle first.
+    for (std::size_t i = 0; i < SlabSize; ++i){
+        slab->hot_[i].next_ = i + 1 < SlabSize ? static_cast<OrderHandle>(base + i + 1) : freeList_;
+    }
+
+    slabs_.push_back(std::move(slab));
+    freeList_ = base;
+}
+
+void OrderPool::PushBack(OrderList& list, OrderHandle handle){
+    Hot(handle).next_ = InvalidOrderHandle;
+    Cold(handle).prev_ = list.tail_;
+
+    if (list.tail_ == InvalidOrderHandle){
+        list.head_ = handle;
+    } else {
+        Hot(list.tail_).next_ = handle;
+    }
+
+    list.tail_ = handle;
+    ++list.size_;
+}
+
+void OrderPool::Erase(OrderList& list, OrderHandle handle){
+    const OrderHandle next = Hot(handle).next_;
+
+    // ! the head is told apart by list.head_, not by its prev_ -> popping the head (every fill) touches hot data only.
+    if (list.head_ == handle){
+        list.head_ = next;  // the new head keeps a stale prev_, never read
+        if (next == InvalidOrderHandle){
+            list.tail_ = InvalidOrderHandle;
+        }
+    } else {
+        const OrderHandle prev = Cold(handle).prev_;
+        Hot(prev).next_ = next;
+        if (next == InvalidOrderHandle){
+            list.tail_ = prev;
+        } else {
+            Cold(next).prev_ = prev;
+        }
+    }
+
+    Hot(handle).next_ = InvalidOrderHandle;
+    --list.size_;
+}
+
+OrderHandle OrderPool::Next(const LevelRing& ring, OrderHandle handle) const{
+    const std::size_t mask = ring.slots_.size() - 1;
+    for (std::uint32_t position = Cold(handle).position_ + 1; position != ring.tail_; ++position){
+        const OrderHandle next = ring.slots_[position & mask];
+        if (next != InvalidOrderHandle) return next;
+    }
+    return InvalidOrderHandle;
+}
+
+void OrderPool::PushBack(LevelRing& ring, OrderHandle handle){
+    if (ring.slots_.empty()){
+        if (spareRings_.empty()){
+            ring.slots_.assign(MinRingSize, InvalidOrderHandle);
+        } else {
+            ring.slots_ = std::move(spareRings_.back());
+            spareRings_.pop_back();
+        }
+        ring.head_ = ring.tail_ = 0;
+    } else if (ring.tail_ - ring.head_ == ring.slots_.size()){
+        MakeRoom(ring);
+    }
+
+    const std::uint32_t position = ring.tail_++;
+    ring.slots_[position & (ring.slots_.size() - 1)] = handle;
+    Cold(handle).position_ = position;
+    ++ring.size_;
+}
+
+void OrderPool::Erase(LevelRing& ring, OrderHandle handle){
+    const std::size_t mask = ring.slots_.size() - 1;
+
+    // ! the front is recognised by its handle -> a fill never reads the cold half for the position.
+    const std::uint32_t position = ring.slots_[ring.head_ & mask] == handle ? ring.head_ : Cold(handle).position_;
+    ring.slots_[position & mask] = InvalidOrderHandle;
+
+    if (--ring.size_ == 0){
+        // all slots are tombstones again -> the buffer can be handed to the next level as-is.
+        spareRings_.push_back(std::move(ring.slots_));
+        ring.slots_.clear();
+        ring.head_ = ring.tail_ = 0;
+        return;
+    }
+
+    // keep both ends on a live order; what is in between stays a tombstone until MakeRoom() or the front gets to it.
+    if (position == ring.head_){
+        do { ++ring.head_; } while (ring.slots_[ring.head_ & mask] == InvalidOrderHandle);
+    } else if (position + 1 == ring.tail_){
+        do { --ring.tail_; } while (ring.slots_[(ring.tail_ - 1) & mask] == InvalidOrderHandle);
+    }
+}
+
+void OrderPool::MakeRoom(LevelRing& ring){
+    const std::size_t capacity = ring.slots_.size();
+    const std::size_t mask = capacity - 1;
+
+    if (ring.size_ <= capacity / 2){
+        // squeeze the live orders towards the front, in order: the write cursor never overtakes the read one.
+        std::uint32_t write = ring.head_;
+        for (std::uint32_t read = ring.head_; read != ring.tail_; ++read){
+            const OrderHandle handle = ring.slots_[read & mask];
+            if (handle == InvalidOrderHandle) continue;
+            ring.slots_[read & mask] = InvalidOrderHandle;
+            ring.slots_[write & mask] = handle;
+            Cold(handle).position_ = write++;
+        }
+        ring.tail_ = write;
+        return;
+    }
+
+    std::vector<OrderHandle> slots(capacity * 2, InvalidOrderHandle);
+    std::uint32_t write = 0;
+    for (std::uint32_t read = ring.head_; read != ring.tail_; ++read){
+        const OrderHandle handle = ring.slots_[read & mask];
+        if (handle == InvalidOrderHandle) continue;
+        slots[write] = handle;
+        Cold(handle).position_ = write++;
+    }
+    ring.slots_ = std::move(slots);
+    ring.head_ = 0;
+    ring.tail_ = write;
+}
+
+void OrderPool::PushBackOwned(OrderList& list, OrderHandle handle){
+    auto& links = Ownership(handle);
+    links.prev_ = list.tail_;
+    links.next_ = InvalidOrderHandle;
+
+    if (list.tail_ == InvalidOrderHandle){
+        list.head_ = handle;
+    } else {
+        Ownership(list.tail_).next_ = handle;
+    }
+
+    list.tail_ = handle;
+    ++list.size_;
+}
+
+void OrderPool::EraseOwned(OrderList& list, OrderHandle handle){
+    auto& links = Ownership(handle);
+
+    if (links.prev_ == InvalidOrderHandle){
+        list.head_ = links.next_;
+    } else {
+        Ownership(links.prev_).next_ = links.next_;
+    }
+
+    if (links.next_ == InvalidOrderHandle){
+        list.tail_ = links.prev_;
+    } else {
+        Ownership(links.next_).prev_ = links.prev_;
+    }
+
+    links.prev_ = InvalidOrderHandle;
+    links.next_ = InvalidOrderHandle;
+    --list.size_;
+}
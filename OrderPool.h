@@ -0,0 +1,172 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Types.h"
+#include "Order.h"
+
+/*
+ * Intrusive FIFO of orders resting at one price level.
+ * The links live inside the OrderPool nodes, so pushing/erasing an order never allocates.
+ */
+struct OrderList{
+    OrderHandle head_{ InvalidOrderHandle };
+    OrderHandle tail_{ InvalidOrderHandle };
+    std::size_t size_{};
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+};
+
+/*
+ * The other per-level FIFO (built with ORDERBOOK_RING_LEVELS): the handles of the level's orders, in a contiguous ring.
+ * A sweep through a deep level reads the handles front to back -> a sequential scan the prefetcher follows,
+ * where the intrusive list has to load each order before it knows where the next one is.
+ *
+ * A cancel leaves a tombstone (InvalidOrderHandle) in the order's slot, found in O(1) from OrderCold::position_.
+ * Tombstones are skipped over as the front and the back move (matching takes the front), and squeezed out
+ * in place when the ring fills up, before it is grown.
+ */
+struct LevelRing{
+    std::vector<OrderHandle> slots_;  // power-of-two size; logical position p lives in slots_[p & (slots_.size() - 1)]
+    std::uint32_t head_{};  // logical position of the front, which is never a tombstone
+    std::uint32_t tail_{};  // one past the back, which is never a tombstone either
+    std::size_t size_{};  // live orders, i.e., not counting the tombstones in between
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+};
+
+// The FIFO the price levels are built with. ? the list is the default until the ring has proven itself on real flow.
+#if ORDERBOOK_RING_LEVELS
+using LevelQueue = LevelRing;
+#else
+using LevelQueue = OrderList;
+#endif
+
+/*
+ * An order as the pool stores it, split in two by how often it is touched.
+ *
+ * Hot: what a sweep through a level reads and writes for every order it fills -> 16 bytes, 4 orders per cache line.
+ * Cold: everything else, only looked at when an order is added, cancelled, amended, expired or snapshotted.
+ * ! prev_ is cold on purpose: taking the head off a level (a fill) never needs it, only an erase from the middle (a cancel) does.
+ */
+struct OrderHot{
+    OrderId orderId_{};
+    Quantity remainingQuantity_{};
+    OrderHandle next_{ InvalidOrderHandle };  // doubles as the free list link while the slot is released.
+};
+
+struct OrderCold{
+    Timestamp expiry_{ NoExpiry };
+    Price price_{};
+    Quantity initialQuantity_{};
+    OrderType orderType_{ OrderType::GoodTillCancel };
+    Side side_{ Side::Buy };
+    OrderHandle prev_{ InvalidOrderHandle };  // ! stale on the head of a list, OrderList::head_ is what tells the head apart
+    std::uint32_t position_{};  // logical position in its LevelRing (ring levels only, otherwise unused) -> fills the padding
+};
+
+// Which owner the order belongs to, and its links in that owner's list (OrderBook::CancelOwnerOrders) -> cold as well.
+struct OrderOwnership{
+    OwnerId owner_{ NoOwner };
+    OrderHandle prev_{ InvalidOrderHandle };
+    OrderHandle next_{ InvalidOrderHandle };
+};
+
+// Iceberg orders only: OrderHot::remainingQuantity_ is what shows of the order, hidden_ what is still held back.
+// ! looked at when the shown part of an order at a level holding icebergs runs out, never on any other fill.
+struct OrderIceberg{
+    Quantity display_{};  // size of each slice shown, 0 = not an iceberg
+    Quantity hidden_{};
+};
+
+static_assert(sizeof(OrderHot) == 16);
+static_assert(sizeof(OrderCold) == 32);
+
+class OrderPool{
+public:
+    OrderPool() = default;
+    explicit OrderPool(std::size_t capacity);
+
+    // the nodes are linked to each other by handle -> copying the pool would silently alias the lists.
+    OrderPool(const OrderPool&) = delete;
+    void operator=(const OrderPool&) = delete;
+
+    // Copy the given order into a free slot and return its handle.
+    // Only touches the allocator if the free list is empty, i.e., the arena is still cold.
+    OrderHandle Allocate(const Order& order);
+    void Release(OrderHandle handle);
+
+    // Pre-allocate enough slabs to hold the given number of orders.
+    void Reserve(std::size_t capacity);
+    std::size_t Capacity() const { return slabs_.size() * SlabSize; }
+
+    // ! Hot() on the matching path, Cold() everywhere else. Both stay valid while the slot is allocated.
+    OrderHot& Hot(OrderHandle handle) { return Slab(handle).hot_[handle & SlabMask]; }
+    const OrderHot& Hot(OrderHandle handle) const { return Slab(handle).hot_[handle & SlabMask]; }
+    OrderCold& Cold(OrderHandle handle) { return Slab(handle).cold_[handle & SlabMask]; }
+    const OrderCold& Cold(OrderHandle handle) const { return Slab(handle).cold_[handle & SlabMask]; }
+    OrderOwnership& Ownership(OrderHandle handle) { return Slab(handle).ownership_[handle & SlabMask]; }
+    const OrderOwnership& Ownership(OrderHandle handle) const { return Slab(handle).ownership_[handle & SlabMask]; }
+    OrderIceberg& Iceberg(OrderHandle handle) { return Slab(handle).iceberg_[handle & SlabMask]; }
+    const OrderIceberg& Iceberg(OrderHandle handle) const { return Slab(handle).iceberg_[handle & SlabMask]; }
+
+    // The whole order, put back together / written back from one (its list links are left alone) -> for the cold paths.
+    // Store() shows a fresh slice of an iceberg, i.e., GetVisibleQuantity(), and holds back the rest.
+    Order Load(OrderHandle handle) const;
+    void Store(OrderHandle handle, const Order& order);
+
+    OrderHandle Next(OrderHandle handle) const { return Hot(handle).next_; }
+
+    // Intrusive list operations, O(1)
+    void PushBack(OrderList& list, OrderHandle handle);
+    void Erase(OrderList& list, OrderHandle handle);
+
+    // The same for both kinds of level FIFO -> the book walks a level without knowing which one it is built with.
+    OrderHandle Front(const OrderList& list) const { return list.head_; }
+    OrderHandle Next(const OrderList&, OrderHandle handle) const { return Next(handle); }
+    OrderHandle Front(const LevelRing& ring) const { return ring.empty() ? InvalidOrderHandle : ring.slots_[ring.head_ & (ring.slots_.size() - 1)]; }
+    OrderHandle Next(const LevelRing& ring, OrderHandle handle) const;  // skips the tombstones, O(1) amortised over a walk
+
+    // Ring operations: O(1), amortised for PushBack(). Erasing the front (a fill) touches no order data at all.
+    void PushBack(LevelRing& ring, OrderHandle handle);
+    void Erase(LevelRing& ring, OrderHandle handle);
+
+    // Same, for the list of the orders of one owner (through the OrderOwnership links) -> an order can be in both at once.
+    void PushBackOwned(OrderList& list, OrderHandle handle);
+    void EraseOwned(OrderList& list, OrderHandle handle);
+    OrderHandle NextOwned(OrderHandle handle) const { return Ownership(handle).next_; }
+
+private:
+    // Slabs are never moved or freed, so a handle stays valid (and so does a reference to its order) for the lifetime of the pool.
+    static constexpr std::size_t SlabShift = 12;
+    static constexpr std::size_t SlabSize = std::size_t{ 1 } << SlabShift;  // 4096 orders per slab
+    static constexpr std::size_t SlabMask = SlabSize - 1;
+
+    // parallel arrays: slot i of a slab is hot_[i] + cold_[i] + ownership_[i] + iceberg_[i] -> consecutive handles pack their hot halves together.
+    struct OrderSlab{
+        OrderHot hot_[SlabSize];
+        OrderCold cold_[SlabSize];
+        OrderOwnership ownership_[SlabSize];
+        OrderIceberg iceberg_[SlabSize];
+    };
+
+    OrderSlab& Slab(OrderHandle handle) { return *slabs_[handle >> SlabShift]; }
+    const OrderSlab& Slab(OrderHandle handle) const { return *slabs_[handle >> SlabShift]; }
+
+    void Grow();
+
+    static constexpr std::size_t MinRingSize = 8;  // slots of a level's first ring buffer
+
+    // Ring full: drop its tombstones in place if that frees enough slots, otherwise move it into a ring twice the size.
+    void MakeRoom(LevelRing& ring);
+
+    std::vector<std::unique_ptr<OrderSlab>> slabs_;
+    OrderHandle freeList_{ InvalidOrderHandle };
+
+    // ! buffers of the rings that ran empty (i.e., of levels about to be erased) -> a new level reuses one instead of allocating.
+    std::vector<std::vector<OrderHandle>> spareRings_;
+};
@@ -0,0 +1,230 @@
+#pragma once
+#include <algorithm> // for std::min
+#include <bit>  // for std::countr_zero
+#include <cstdint>
+#include <cstddef>
+#include <functional> // for std::less, std::greater
+#include <map>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+#include "Types.h"
+#include "LevelScan.h"
+
+/*
+ * One side of the book: price -> Level, iterated from the best price to the worst.
+ *
+ * Prices inside the configured window [basePrice, basePrice + (windowLevels - 1) * tickSize] that sit on a tick
+ * are stored in a contiguous array, indexed by their distance from the best end of the window:
+    * Sell (asks) -> index 0 is the lowest price of the window
+    * Buy (bids) -> index 0 is the highest price of the window
+ * so for both sides "better price" == "lower index", and the best level is the lowest set bit of occupied_.
+ *
+ * Every other price (outside the window, or off-tick) falls back to a std::map, as before.
+ * With windowLevels == 0 the ladder is just the map.
+ */
+template <typename Level, Side side>
+class PriceLadder{
+public:
+    // ! Sell -> ascending, Buy -> descending (same ordering as the old std::map comparators)
+    using Compare = std::conditional_t<side == Side::Buy, std::greater<Price>, std::less<Price>>;
+
+    PriceLadder(Price basePrice, Price tickSize, std::size_t windowLevels, std::pmr::memory_resource* resource)
+        : basePrice_{ basePrice }
+        , tickSize_{ tickSize > 0 ? tickSize : 1 }
+        , levels_(windowLevels)
+        , quantities_(windowLevels)
+        , occupied_((windowLevels + WordBits - 1) / WordBits)
+        , overflow_{ resource }
+    {}
+
+    bool empty() const { return windowCount_ == 0 && overflow_.empty(); }
+    std::size_t size() const { return windowCount_ + overflow_.size(); }  // number of non-empty levels
+
+    // ! Only valid if the ladder is not empty.
+    Price BestPrice() const { return BestInWindow() ? PriceAt(best_) : overflow_.begin()->first; }
+    Level& Best() { return BestInWindow() ? levels_[best_] : overflow_.begin()->second; }
+    const Level& Best() const { return BestInWindow() ? levels_[best_] : overflow_.begin()->second; }
+
+    // Get the level at the given price, creating an empty one if needed.
+    Level& operator[](Price price){
+        std::size_t index;
+        if (!ToIndex(price, index)){
+            return overflow_[price];
+        }
+
+        if (!IsOccupied(index)){
+            occupied_[index / WordBits] |= Bit(index);
+            ++windowCount_;
+            if (best_ == NoLevel || index < best_){
+                best_ = index;
+            }
+        }
+        return levels_[index];
+    }
+
+    Level* Find(Price price){
+        std::size_t index;
+        if (!ToIndex(price, index)){
+            auto level = overflow_.find(price);
+            return level == overflow_.end() ? nullptr : &level->second;
+        }
+        return IsOccupied(index) ? &levels_[index] : nullptr;
+    }
+
+    void Erase(Price price){
+        std::size_t index;
+        if (!ToIndex(price, index)){
+            overflow_.erase(price);
+            return;
+        }
+
+        if (!IsOccupied(index)) return;
+
+        levels_[index] = Level{};  // the slot is reused as-is the next time this price shows up.
+        quantities_[index] = 0;
+        occupied_[index / WordBits] &= ~Bit(index);
+        --windowCount_;
+        if (index == best_){
+            best_ = NextOccupied(index + 1);
+        }
+    }
+
+    /*
+     * The total quantity resting at a level, as maintained by the owner of the ladder (the book, on every level change).
+     * Only the window keeps it, densely by index -> the scans below run over it without touching the levels themselves.
+     */
+    void SetQuantity(Price price, Quantity quantity){
+        std::size_t index;
+        if (ToIndex(price, index)){
+            quantities_[index] = quantity;
+        }
+    }
+
+    /*
+     * Total quantity of the levels at `limit` or better, counted until it reaches `target` (the result can stop short of the
+     * full total once it is >= target). quantityOf(const Level&) gives the quantity of an overflow level.
+     */
+    template <typename QuantityOf>
+    std::uint64_t QuantityUpTo(Price limit, std::uint64_t target, QuantityOf&& quantityOf) const {
+        std::uint64_t sum = 0;
+        for (auto level = overflow_.begin(); level != overflow_.end() && !Better(limit, level->first) && sum < target; ++level){
+            sum += quantityOf(level->second);
+        }
+        if (sum >= target || best_ == NoLevel) return sum;
+
+        const std::size_t end = EndIndexUpTo(limit);
+        if (end <= best_) return sum;
+
+        std::size_t levels;
+        return sum + LevelScan::SumUntil(quantities_.data() + best_, end - best_, target - sum, levels);
+    }
+
+    /*
+     * Visit the levels from the best price to the worst one: visitor(Price, const Level&) -> bool
+     * Returning false from the visitor stops the walk, e.g., once an order has been covered.
+     * The window and the overflow map are merged on the fly, so an off-tick price still comes out in order.
+     */
+    template <typename Visitor>
+    void ForEach(Visitor&& visitor) const {
+        Walk(best_, overflow_.begin(), visitor);
+    }
+
+    // Same, starting at the first level at `price` or worse -> the levels in front of it are skipped, not visited.
+    template <typename Visitor>
+    void ForEachFrom(Price price, Visitor&& visitor) const {
+        Walk(NextOccupied(FirstIndexFrom(price)), overflow_.lower_bound(price), visitor);
+    }
+
+private:
+    using Word = std::uint64_t;
+    static constexpr std::size_t WordBits = 64;
+    static constexpr std::size_t NoLevel = static_cast<std::size_t>(-1);
+
+    template <typename Visitor>
+    void Walk(std::size_t index, typename std::pmr::map<Price, Level, Compare>::const_iterator overflow, Visitor& visitor) const {
+        while (index != NoLevel || overflow != overflow_.end()){
+            if (index != NoLevel && (overflow == overflow_.end() || Better(PriceAt(index), overflow->first))){
+                if (!visitor(PriceAt(index), levels_[index])) return;
+                index = NextOccupied(index + 1);
+            } else {
+                if (!visitor(overflow->first, overflow->second)) return;
+                ++overflow;
+            }
+        }
+    }
+
+    // one past the last window index whose price is `price` or better.
+    std::size_t EndIndexUpTo(Price price) const {
+        const std::size_t index = FirstIndexFrom(price);
+        return index < levels_.size() && PriceAt(index) == price ? index + 1 : index;
+    }
+
+    // lowest window index whose price is `price` or worse (levels_.size() if there is none).
+    std::size_t FirstIndexFrom(Price price) const {
+        const auto levels = static_cast<std::int64_t>(levels_.size());
+        const std::int64_t offset = std::int64_t{ price } - basePrice_;
+        std::int64_t tick;
+        if constexpr (side == Side::Buy){
+            // worse = lower: the ticks at or below the price, i.e., floor(offset / tickSize_)
+            tick = offset >= 0 ? offset / tickSize_ : -((-offset + tickSize_ - 1) / tickSize_);
+            if (tick < 0) return levels_.size();
+            return static_cast<std::size_t>(levels - 1 - std::min(tick, levels - 1));
+        } else {
+            // worse = higher: the ticks at or above the price, i.e., ceil(offset / tickSize_)
+            tick = offset <= 0 ? 0 : (offset + tickSize_ - 1) / tickSize_;
+            return static_cast<std::size_t>(std::min(tick, levels));
+        }
+    }
+
+    static Word Bit(std::size_t index) { return Word{ 1 } << (index % WordBits); }
+    static bool Better(Price lhs, Price rhs) { return Compare{}(lhs, rhs); }
+
+    bool IsOccupied(std::size_t index) const { return occupied_[index / WordBits] & Bit(index); }
+
+    // the array level wins whenever it is at least as good as the front of the overflow map (they can never hold the same price).
+    bool BestInWindow() const {
+        return best_ != NoLevel && (overflow_.empty() || Better(PriceAt(best_), overflow_.begin()->first));
+    }
+
+    bool ToIndex(Price price, std::size_t& index) const {
+        const std::int64_t offset = std::int64_t{ price } - basePrice_;
+        if (offset < 0 || offset % tickSize_ != 0) return false;
+
+        const auto tick = static_cast<std::size_t>(offset / tickSize_);
+        if (tick >= levels_.size()) return false;
+
+        index = side == Side::Buy ? levels_.size() - 1 - tick : tick;
+        return true;
+    }
+
+    Price PriceAt(std::size_t index) const {
+        const std::size_t tick = side == Side::Buy ? levels_.size() - 1 - index : index;
+        return static_cast<Price>(basePrice_ + static_cast<std::int64_t>(tick) * tickSize_);
+    }
+
+    // first occupied index >= from, one word (64 levels) at a time.
+    std::size_t NextOccupied(std::size_t from) const {
+        if (from >= levels_.size()) return NoLevel;
+
+        std::size_t word = from / WordBits;
+        Word bits = occupied_[word] & (~Word{ 0 } << (from % WordBits));
+        while (bits == 0){
+            if (++word == occupied_.size()) return NoLevel;
+            bits = occupied_[word];
+        }
+        return word * WordBits + std::countr_zero(bits);
+    }
+
+    Price basePrice_;
+    Price tickSize_;
+
+    std::vector<Level> levels_;  // sized once at construction, never reallocated.
+    std::vector<Quantity> quantities_;  // quantities_[i]: total quantity resting at levels_[i], 0 when it is empty.
+    std::vector<Word> occupied_;  // bit i set <=> levels_[i] holds at least one order.
+    std::size_t windowCount_{};
+    std::size_t best_{ NoLevel };  // cursor on the best occupied index of the window.
+
+    std::pmr::map<Price, Level, Compare> overflow_;
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+#include "Types.h"
+
+/*
+ * Pre-trade checks and self-trade prevention, run by the book itself inside AddOrder() / ModifyOrder() and the matching loops
+ * -> a risk layer in front of the book does not need a lock or a position lookup of its own for these.
+ *
+ * Which of them the book runs is fixed at compile time (CMake: ORDERBOOK_RISK_* and ORDERBOOK_SELF_TRADE_PREVENTION),
+ * as the BookRiskPolicy below, and every one is behind an `if constexpr` -> a disabled check is not in the binary at all.
+ * The limits they check against are run-time settings (OrderBookConfig::risk_), the same for every owner.
+ */
+
+enum class SelfTradePrevention : std::uint8_t{
+    None,
+    CancelNewest,  // the incoming order (the aggressor) is cancelled, the resting one stays
+    CancelOldest,  // the resting order is cancelled, the incoming one goes on matching
+    CancelBoth,
+};
+
+/*
+ * ! Every check only reads what the order path has in hand already:
+    * MaxQuantity -> the incoming order
+    * PriceBand -> the best price of the opposite side, the one the order is about to be matched against
+    * OwnerCredit -> the owner's entry of the book's owner map, looked up anyway to put the order on the owner's list
+    * SelfTrade -> the OrderOwnership of the two orders about to trade, and only if the aggressor has an owner
+ */
+template <bool MaxQuantity, bool PriceBand, bool OwnerCredit, SelfTradePrevention SelfTrade>
+struct RiskPolicy{
+    static constexpr bool CheckMaxQuantity = MaxQuantity;
+    static constexpr bool CheckPriceBand = PriceBand;
+    static constexpr bool CheckOwnerCredit = OwnerCredit;
+    static constexpr SelfTradePrevention Prevention = SelfTrade;
+
+    static constexpr bool PreTrade = MaxQuantity || PriceBand || OwnerCredit;
+    static constexpr bool PreventsSelfTrade = SelfTrade != SelfTradePrevention::None;
+    static constexpr bool CancelsNewest = SelfTrade == SelfTradePrevention::CancelNewest || SelfTrade == SelfTradePrevention::CancelBoth;
+    static constexpr bool CancelsOldest = SelfTrade == SelfTradePrevention::CancelOldest || SelfTrade == SelfTradePrevention::CancelBoth;
+};
+
+// The limits of the checks compiled in; the limit of a check that is compiled out is ignored.
+struct RiskLimits{
+    Quantity maxOrderQuantity_{ std::numeric_limits<Quantity>::max() };  // largest quantity of one add or amend
+    // a limit price may be at most this far through the opposite best (a buy above best ask + band, a sell below best bid - band)
+    Price priceBand_{ std::numeric_limits<Price>::max() };
+    /*
+     * Most notional (price x quantity) an owner may have resting. An order counts at its full size until it leaves the book,
+     * partial fills included -> the fills never have to look at the owner. FAK and FOK orders are checked against what is left,
+     * Market orders (no price to value them at) and orders without an owner are not checked.
+     */
+    std::uint64_t ownerCredit_{ std::numeric_limits<std::uint64_t>::max() };
+};
+
+#ifndef ORDERBOOK_RISK_MAX_QUANTITY
+#define ORDERBOOK_RISK_MAX_QUANTITY 0
+#endif
+#ifndef ORDERBOOK_RISK_PRICE_BAND
+#define ORDERBOOK_RISK_PRICE_BAND 0
+#endif
+#ifndef ORDERBOOK_RISK_OWNER_CREDIT
+#define ORDERBOOK_RISK_OWNER_CREDIT 0
+#endif
+#ifndef ORDERBOOK_SELF_TRADE_PREVENTION
+#define ORDERBOOK_SELF_TRADE_PREVENTION None  // one of the SelfTradePrevention values
+#endif
+
+// The policy the book is built with.
+using BookRiskPolicy = RiskPolicy<
+    ORDERBOOK_RISK_MAX_QUANTITY != 0,
+    ORDERBOOK_RISK_PRICE_BAND != 0,
+    ORDERBOOK_RISK_OWNER_CREDIT != 0,
+    SelfTradePrevention::ORDERBOOK_SELF_TRADE_PREVENTION
+>;
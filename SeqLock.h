@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>  // for std::memcpy
+#include <type_traits>
+
+/*
+ * One value, written by a single thread and read by any number of others without a lock (a sequence lock).
+ *
+ * The writer bumps the sequence to odd, writes the value, then bumps it to even again. A reader copies the value
+ * between two loads of the sequence and retries if they differ (or are odd) -> it never writes to the shared lines,
+ * so readers cannot slow down the writer or each other, and the writer never waits for a reader.
+ * The value is copied word by word through relaxed atomics -> a torn read is detected and retried, never undefined behaviour.
+ *
+ * ! Single writer. A reader spins while a write is in progress, i.e., for a few nanoseconds at most.
+ */
+template <typename T>
+class alignas(64) SeqLock{
+    static_assert(std::is_trivially_copyable_v<T>, "copied word by word");
+    static_assert(sizeof(T) % sizeof(std::uint64_t) == 0, "copied word by word");
+
+public:
+    SeqLock() { Store(T{}); }
+
+    SeqLock(const SeqLock&) = delete;
+    void operator=(const SeqLock&) = delete;
+
+    void Store(const T& value){
+        const std::uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);  // nobody sees the new words before the odd sequence
+
+        std::uint64_t source[Words];
+        std::memcpy(source, &value, sizeof(T));
+        for (std::size_t i = 0; i < Words; ++i){
+            std::atomic_ref<std::uint64_t>{ words_[i] }.store(source[i], std::memory_order_relaxed);
+        }
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    T Load() const {
+        std::uint64_t copy[Words];
+        while (true){
+            const std::uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1){
+                continue;  // a write is in progress
+            }
+
+            for (std::size_t i = 0; i < Words; ++i){
+                copy[i] = std::atomic_ref<std::uint64_t>{ words_[i] }.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);  // the copy is done before the sequence is read again
+
+            if (sequence_.load(std::memory_order_relaxed) == before) break;
+        }
+
+        T value;
+        std::memcpy(&value, copy, sizeof(T));
+        return value;
+    }
+
+    // Number of Store() calls so far -> a reader can tell whether anything changed since its last Load().
+    std::uint64_t Version() const { return sequence_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr std::size_t Words = sizeof(T) / sizeof(std::uint64_t);
+
+    std::atomic<std::uint64_t> sequence_{ 0 };
+    mutable std::uint64_t words_[Words]{};  // ! mutable: std::atomic_ref<const T> is C++26, the readers only ever load
+};
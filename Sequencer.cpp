@@ -0,0 +1,211 @@
+#include <algorithm> // for std::min
+
+#include "Sequencer.h"
+#include "ThreadAffinity.h"
+
+namespace {
+    OrderBookConfig SingleWriter(OrderBookConfig config){
+        config.singleWriter_ = true;
+        return config;
+    }
+
+    // commands taken from one ring per pass -> a busy producer cannot starve the others.
+    constexpr std::size_t DrainBatch = 64;
+}
+
+Sequencer::Sequencer(const OrderBookConfig& bookConfig, const SequencerConfig& config, ResultCallback onResult)
+    : bookConfig_{ SingleWriter(bookConfig) }
+    , onResult_{ std::move(onResult) }
+    , config_{ config }
+{
+    rings_.reserve(config.producers_);
+    for (std::size_t i = 0; i < config.producers_; ++i){
+        rings_.push_back(std::make_unique<SpscRing<OrderCommand>>(config.ringCapacity_));
+    }
+
+    matcherThread_ = std::thread{ [this] { Run(); } };
+    if (config_.housekeeping_){
+        housekeepingThread_ = std::thread{ [this] { Housekeep(); } };
+    }
+}
+
+Sequencer::~Sequencer(){
+    {
+        // under the mutex -> the housekeeping thread cannot miss the wake-up between its check and its wait.
+        std::scoped_lock lock{ housekeepingMutex_ };
+        shutdown_.store(true, std::memory_order_release);
+    }
+    housekeepingWakeUp_.notify_all();
+
+    if (matcherThread_.joinable()){
+        matcherThread_.join();
+    }
+    if (housekeepingThread_.joinable()){
+        housekeepingThread_.join();
+    }
+    delete pendingSnapshot_.exchange(nullptr);  // captured, but shut down before it could be written
+}
+
+bool Sequencer::Submit(std::size_t producer, const OrderCommand& command){
+    return rings_[producer]->TryPush(command);
+}
+
+void Sequencer::Run(){
+    // pinned and on local memory before the book exists -> every page of it is first touched from this core's node.
+    PinCurrentThread(config_.matcherCpu_);
+    if (config_.matcherCpu_ >= 0){
+        PreferLocalMemory();
+    }
+    book_ = std::make_unique<OrderBook>(bookConfig_);
+
+    // without a housekeeping thread the matcher keeps the time itself: next pass at which it commits the journal and expires.
+    auto nextHousekeeping = std::chrono::system_clock::now();
+
+    while (true){
+        // read the flag before draining: commands pushed before the destructor ran are still applied by the final pass.
+        const bool shutdown = shutdown_.load(std::memory_order_acquire);
+
+        const std::size_t applied = Drain();
+
+        // between two passes, loaded or not -> expiry keeps up under a steady flow, one chunk per pass at most.
+        if (config_.housekeeping_){
+            RunTasks();
+        } else {
+            // once per expiry tick even when every pass applies something -> a steady flow cannot starve the journal or expiry.
+            const auto now = std::chrono::system_clock::now();
+            if (applied == 0 || now >= nextHousekeeping){
+                book_->CommitJournal();  // group commit of whatever was journaled since the last one
+                const bool expired = book_->ExpireOrders(now);  // one chunk, the next pass takes another if more are due
+                nextHousekeeping = expired ? now + bookConfig_.expiryTick_ : now;
+            }
+        }
+
+        if (applied == 0){
+            if (shutdown){
+                book_->CommitJournal();  // everything applied is in the journal's hands before the matcher goes
+                return;
+            }
+            Idle();
+        }
+    }
+}
+
+void Sequencer::Idle(){
+    if (config_.busyPoll_){
+        CpuRelax();
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+std::size_t Sequencer::Drain(){
+    std::size_t applied = 0;
+    OrderCommand command;
+
+    for (std::size_t producer = 0; producer < rings_.size(); ++producer){
+        auto& ring = *rings_[producer];
+        for (std::size_t i = 0; i < DrainBatch && ring.TryPop(command); ++i){
+            Apply(producer, command);
+            ++applied;
+        }
+    }
+
+    processed_.fetch_add(applied, std::memory_order_relaxed);
+    return applied;
+}
+
+void Sequencer::Apply(std::size_t producer, const OrderCommand& command){
+    // reuse one buffer for every command -> once it has grown to the largest sweep, reporting does not allocate.
+    trades_.clear();
+    const OrderResult result = book_->Apply(command, [this](const Trade& trade){ trades_.push_back(trade); });
+
+    if (onResult_){
+        onResult_(producer, command, result, trades_);
+    }
+}
+
+void Sequencer::RunTasks(){
+    Task task;
+    while (tasks_.TryPop(task)){
+        switch (task.type_){
+            case TaskType::Expire:
+                book_->CommitJournal();  // every expiry tick, like the expiry itself -> loaded or not
+                expiring_ = true;
+                expiringAt_ = task.time_;  // a later tick supersedes the one still being worked through
+                break;
+            case TaskType::Snapshot: {
+                // the copy is the only part that needs the book; skipped while the previous one is still being written.
+                if (pendingSnapshot_.load(std::memory_order_acquire) != nullptr) break;
+                auto image = std::make_unique<SnapshotImage>();
+                if (book_->CaptureSnapshot(*image)){
+                    pendingSnapshot_.store(image.release(), std::memory_order_release);
+                } else {
+                    snapshotFailures_.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            }
+            case TaskType::Stats:
+                stats_.Store(SequencerStats{
+                    processed_.load(std::memory_order_relaxed),
+                    book_->Size(),
+                    snapshotsWritten_.load(std::memory_order_relaxed),
+                    snapshotFailures_.load(std::memory_order_relaxed)
+                });
+                break;
+        }
+    }
+
+    if (expiring_){
+        expiring_ = !book_->ExpireOrders(expiringAt_);
+    }
+}
+
+void Sequencer::Housekeep(){
+    using namespace std::chrono;
+    PinCurrentThread(config_.housekeepingCpu_);
+
+    const auto now = system_clock::now();
+    auto nextExpiry = now;
+    auto nextSnapshot = now + config_.snapshotInterval_;
+    auto nextStats = now;
+
+    // a full ring means the matcher is behind -> the task is dropped, the next one of its kind comes soon enough.
+    auto Post = [this](TaskType type, Timestamp time){ tasks_.TryPush(Task{ type, time }); };
+
+    while (true){
+        WritePendingSnapshot();
+
+        const auto time = system_clock::now();
+        if (time >= nextExpiry){
+            Post(TaskType::Expire, time);
+            nextExpiry = time + bookConfig_.expiryTick_;
+        }
+        if (!config_.snapshotPath_.empty() && time >= nextSnapshot){
+            Post(TaskType::Snapshot, time);
+            nextSnapshot = time + config_.snapshotInterval_;
+        }
+        if (time >= nextStats){
+            Post(TaskType::Stats, time);
+            nextStats = time + config_.statsInterval_;
+        }
+
+        // sleep until the next task is due -> a captured snapshot is written within one expiry tick.
+        std::unique_lock lock{ housekeepingMutex_ };
+        if (housekeepingWakeUp_.wait_until(lock, std::min(nextExpiry, nextStats), [this]{ return shutdown_.load(std::memory_order_acquire); })){
+            return;
+        }
+    }
+}
+
+void Sequencer::WritePendingSnapshot(){
+    const std::unique_ptr<SnapshotImage> image{ pendingSnapshot_.exchange(nullptr, std::memory_order_acq_rel) };
+    if (!image) return;
+
+    // ! never ahead of the durable journal -> wait for it here, the matcher only handed it to the writer.
+    Journal* journal = bookConfig_.journal_;
+    if ((!journal || journal->WaitCommitted(image->header_.journalSequence_)) && OrderBook::WriteSnapshot(config_.snapshotPath_, *image)){
+        snapshotsWritten_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        snapshotFailures_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OrderBook.h"
+#include "OrderBookConfig.h"
+#include "OrderCommand.h"
+#include "SeqLock.h"
+#include "Snapshot.h"
+#include "SpscRing.h"
+#include "Trade.h"
+
+struct SequencerConfig{
+    std::size_t producers_{ 1 };  // number of gateway threads, each gets its own ring.
+    std::size_t ringCapacity_{ 1 << 16 };  // commands per producer ring (rounded up to a power of two).
+    int matcherCpu_{ -1 };  // pin the matching thread to this core, -1 leaves it to the scheduler.
+
+    // Idle matcher: spin on the rings (with a pause hint) instead of yielding its core -> the lowest wake-up latency,
+    // for an isolated core (isolcpus / nohz_full) that has nothing else to run anyway.
+    bool busyPoll_{ false };
+
+    /*
+     * Housekeeping thread, pinned to housekeepingCpu_: it keeps the time for expiry, snapshots and stats, and hands each
+     * one to the matcher as a task through a ring of its own -> nothing but the matcher ever touches the book, and the matcher
+     * does not read the clock for any of them. The slow part of a snapshot (the write) goes back to the housekeeping thread.
+     * The Expire task also commits the book's journal.
+     * false: the matcher reads the clock once per pass and, every expiry tick (and on idle passes), commits the journal and
+     * expires orders itself; there are no periodic snapshots or stats.
+     */
+    bool housekeeping_{ false };
+    int housekeepingCpu_{ -1 };
+    std::string snapshotPath_;  // empty: no periodic snapshot
+    std::chrono::milliseconds snapshotInterval_{ std::chrono::seconds{ 60 } };
+    std::chrono::milliseconds statsInterval_{ std::chrono::seconds{ 1 } };
+};
+
+// Published by the matcher on every stats task, read from any thread without touching the book.
+struct SequencerStats{
+    std::uint64_t processed_{ 0 };  // commands applied so far
+    std::uint64_t restingOrders_{ 0 };
+    std::uint64_t snapshots_{ 0 };  // written successfully
+    std::uint64_t snapshotFailures_{ 0 };
+};
+
+/*
+ * Lock-free ingress in front of a single-writer OrderBook.
+ *
+ * Every producer thread owns one SPSC ring and pushes commands into it with Submit().
+ * One matching thread drains the rings round-robin, applies the commands to the book in that sequence,
+ * and reports each one (with its OrderResult and the trades it caused) through the result callback.
+ * The book is only ever touched by the matching thread, so no lock is taken anywhere on the path.
+ *
+ * ! The book is built by the matching thread itself, once pinned -> its memory is first touched there, i.e., allocated
+ * ! on that core's NUMA node.
+ */
+class Sequencer{
+public:
+    // Called on the matching thread once per command, in sequence.
+    using ResultCallback = std::function<void(std::size_t producer, const OrderCommand& command, OrderResult result, const Trades& trades)>;
+
+    Sequencer(const OrderBookConfig& bookConfig, const SequencerConfig& config, ResultCallback onResult);
+
+    Sequencer(const Sequencer&) = delete;
+    void operator=(const Sequencer&) = delete;
+    Sequencer(Sequencer&&) = delete;
+    void operator=(Sequencer&&) = delete;
+
+    // Drains whatever has already been submitted, then stops the matching thread.
+    ~Sequencer();
+
+    // Producer side: must only be called from the thread owning the given producer index.
+    // Returns false if that producer's ring is full -> the caller decides whether to retry or reject.
+    bool Submit(std::size_t producer, const OrderCommand& command);
+
+    std::size_t Producers() const { return rings_.size(); }
+    std::uint64_t Processed() const { return processed_.load(std::memory_order_relaxed); }
+    SequencerStats Stats() const { return stats_.Load(); }  // as of the last stats task (housekeeping only)
+
+private:
+    enum class TaskType : std::uint8_t{
+        Expire,  // cancel what has expired at time_, one chunk per pass until nothing is due
+        Snapshot,  // copy the book for the housekeeping thread to write out
+        Stats,  // publish stats_
+    };
+
+    struct Task{
+        TaskType type_{ TaskType::Stats };
+        Timestamp time_{};
+    };
+
+    void Run();
+    std::size_t Drain();  // one round-robin pass over the rings, returns the number of commands applied.
+    void Apply(std::size_t producer, const OrderCommand& command);
+    void RunTasks();  // matcher side of the housekeeping
+    void Idle();
+
+    void Housekeep();  // body of the housekeeping thread
+    void WritePendingSnapshot();
+
+    const OrderBookConfig bookConfig_;
+    std::unique_ptr<OrderBook> book_;  // built (and only ever touched) by the matching thread
+    std::vector<std::unique_ptr<SpscRing<OrderCommand>>> rings_;
+    ResultCallback onResult_;
+    Trades trades_;  // scratch buffer of the matching thread
+    const SequencerConfig config_;
+
+    // housekeeping thread -> matcher
+    SpscRing<Task> tasks_{ 64 };
+    bool expiring_{ false };  // matcher: an Expire task is still being worked through
+    Timestamp expiringAt_{};
+
+    // matcher -> housekeeping thread: one captured snapshot at a time, written (and deleted) by the housekeeping thread.
+    std::atomic<SnapshotImage*> pendingSnapshot_{ nullptr };
+    std::atomic<std::uint64_t> snapshotsWritten_{ 0 };
+    std::atomic<std::uint64_t> snapshotFailures_{ 0 };
+    SeqLock<SequencerStats> stats_;
+
+    std::atomic<std::uint64_t> processed_{ 0 };
+    std::atomic<bool> shutdown_{ false };
+    std::mutex housekeepingMutex_;  // only to put the housekeeping thread to sleep, the matcher never takes it
+    std::condition_variable housekeepingWakeUp_;
+
+    // last members: started once everything above is constructed.
+    std::thread matcherThread_;
+    std::thread housekeepingThread_;
+};
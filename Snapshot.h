@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Types.h"
+
+/*
+ * On-disk layout of a book snapshot, flat so it can be mmap-ed and walked in place:
+    * [ SnapshotHeader | orderCount_ x SnapshotOrder ]
+ * The orders are written bids first then asks, each side from its best level to its worst and in time priority
+ * within a level -> restoring is a straight append of every order to the back of its level, no sorting, no matching.
+ * The pending stop orders follow, buy stops then sell stops, each in trigger order.
+ */
+struct SnapshotHeader{
+    std::uint64_t magic_{};
+    std::uint16_t version_{};
+    std::uint16_t flags_{};  // SnapshotFormat::*Flag
+    SymbolId symbol_{};
+    std::uint64_t journalSequence_{};  // the snapshot covers every journal record before this one
+    std::uint64_t orderCount_{};
+};
+
+struct SnapshotOrder{
+    OrderId orderId_{};
+    std::int64_t expiry_{};  // nanoseconds since the epoch, INT64_MAX = NoExpiry
+    Price price_{};
+    Quantity initialQuantity_{};
+    Quantity remainingQuantity_{};
+    std::uint8_t orderType_{};  // OrderType
+    std::uint8_t side_{};  // Side
+    std::uint8_t reserved_[2]{};
+    OwnerId owner_{};
+    Price stopPrice_{};  // Stop and StopLimit only
+    Quantity displayQuantity_{};  // iceberg display size, 0 = fully displayed
+    Quantity visibleQuantity_{};  // icebergs only: what shows of remainingQuantity_ now, the rest is in reserve
+};
+
+static_assert(sizeof(SnapshotHeader) == 32);
+static_assert(sizeof(SnapshotOrder) == 48);
+
+// A snapshot taken in memory (OrderBook::CaptureSnapshot()), written to disk later on, possibly by another thread.
+struct SnapshotImage{
+    SnapshotHeader header_{};
+    std::vector<SnapshotOrder> orders_;  // in file order
+};
+
+namespace SnapshotFormat{
+    inline constexpr std::uint64_t Magic = 0x50414e534b4f4f42;  // "BOOKSNAP"
+    inline constexpr std::uint16_t Version = 1;  // the only one read: a file of any other version is rejected
+
+    inline constexpr std::uint16_t AuctionFlag = 1;  // taken during a call auction -> the book may be crossed, and is restored in the auction
+
+    // What OrderBook::CaptureSnapshot() can have written; anything else is a corrupt (or forged) file.
+    inline bool ValidOrder(const SnapshotOrder& order){
+        if (order.side_ > static_cast<std::uint8_t>(Side::Sell)) return false;
+        if (order.orderType_ > static_cast<std::uint8_t>(OrderType::StopLimit)) return false;
+        if (order.remainingQuantity_ == 0 || order.remainingQuantity_ > order.initialQuantity_) return false;
+
+        const auto type = static_cast<OrderType>(order.orderType_);
+        const bool unpriced = type == OrderType::Market || type == OrderType::Stop;
+        if (!unpriced && order.price_ == Constants::InvalidPrice) return false;
+        if ((type == OrderType::Stop || type == OrderType::StopLimit) && order.stopPrice_ == Constants::InvalidPrice) return false;
+        return true;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <bit>  // for std::bit_ceil
+#include <cstddef>
+#include <memory>
+
+/*
+ * Bounded single-producer / single-consumer ring buffer.
+ *
+ * Exactly one thread may call TryPush() and exactly one (other) thread may call TryPop().
+ * No locks and no allocation after construction: the producer only writes tail_, the consumer only writes head_,
+ * and each side keeps a cached copy of the other's index so it touches the shared cache line only when it looks full/empty.
+ */
+template <typename T>
+class SpscRing{
+public:
+    // the capacity is rounded up to a power of two, so the index wraps with a mask instead of a modulo.
+    explicit SpscRing(std::size_t capacity)
+        : capacity_{ std::bit_ceil(capacity < 2 ? std::size_t{ 2 } : capacity) }
+        , mask_{ capacity_ - 1 }
+        , slots_{ std::make_unique<T[]>(capacity_) }
+    {}
+
+    SpscRing(const SpscRing&) = delete;
+    void operator=(const SpscRing&) = delete;
+
+    // Producer side. Returns false (and drops nothing) if the ring is full.
+    bool TryPush(const T& value){
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ == capacity_){
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ == capacity_) return false;
+        }
+
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);  // publish the slot to the consumer
+        return true;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool TryPop(T& value){
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_){
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) return false;
+        }
+
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);  // hand the slot back to the producer
+        return true;
+    }
+
+    bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+    std::size_t capacity() const { return capacity_; }
+
+private:
+    static constexpr std::size_t CacheLine = 64;
+
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    const std::unique_ptr<T[]> slots_;
+
+    // ! keep the consumer's and the producer's indices on separate cache lines -> no false sharing.
+    alignas(CacheLine) std::atomic<std::size_t> head_{ 0 };
+    std::size_t cachedTail_{ 0 };  // consumer's view of tail_
+
+    alignas(CacheLine) std::atomic<std::size_t> tail_{ 0 };
+    std::size_t cachedHead_{ 0 };  // producer's view of head_
+};
@@ -0,0 +1,58 @@
+#include "StopBook.h"
+
+StopBook::StopBook(std::pmr::memory_resource* resource)
+    : buys_{ resource }
+    , sells_{ resource }
+    , index_{ resource }
+{}
+
+void StopBook::Add(const Order& order){
+    Location location;
+    location.side_ = order.GetSide();
+    if (order.GetSide() == Side::Buy){
+        location.buy_ = buys_.emplace(order.GetStopPrice(), order);
+    } else {
+        location.sell_ = sells_.emplace(order.GetStopPrice(), order);
+    }
+    index_.emplace(order.GetOrderId(), location);
+}
+
+const Order* StopBook::Find(OrderId orderId) const {
+    const auto entry = index_.find(orderId);
+    if (entry == index_.end()) return nullptr;
+    return entry->second.side_ == Side::Buy ? &entry->second.buy_->second : &entry->second.sell_->second;
+}
+
+bool StopBook::Cancel(OrderId orderId){
+    const auto entry = index_.find(orderId);
+    if (entry == index_.end()) return false;
+
+    if (entry->second.side_ == Side::Buy){
+        buys_.erase(entry->second.buy_);
+    } else {
+        sells_.erase(entry->second.sell_);
+    }
+    index_.erase(entry);
+    return true;
+}
+
+void StopBook::Collect(Price low, Price high, std::vector<Order>& triggered){
+    // only the fronts are looked at: the first stop that does not trigger ends its side.
+    while (!buys_.empty() && buys_.begin()->first <= high){
+        triggered.push_back(buys_.begin()->second);
+        index_.erase(buys_.begin()->second.GetOrderId());
+        buys_.erase(buys_.begin());
+    }
+
+    while (!sells_.empty() && sells_.begin()->first >= low){
+        triggered.push_back(sells_.begin()->second);
+        index_.erase(sells_.begin()->second.GetOrderId());
+        sells_.erase(sells_.begin());
+    }
+}
+
+void StopBook::CollectOwner(OwnerId owner, std::vector<OrderId>& orderIds) const {
+    ForEach([&](const Order& order){
+        if (order.GetOwner() == owner) orderIds.push_back(order.GetOrderId());
+    });
+}
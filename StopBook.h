@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <functional>  // for std::less, std::greater
+#include <map>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+#include "Types.h"
+#include "Order.h"
+
+/*
+ * Stop and stop-limit orders waiting for their trigger, kept away from the price levels.
+ *
+ * A buy stop triggers once the market trades at or above its stop price, a sell stop once it trades at or below it.
+ * Each side is sorted by stop price from the first to trigger, orders on the same stop price in arrival order
+ * -> the book only ever looks at the front of each side: checking a trade costs nothing unless something triggers,
+ * and then O(triggered), however many stops are pending.
+ *
+ * ! Not synchronised by itself: the book calls it under its own lock.
+ */
+class StopBook{
+public:
+    explicit StopBook(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    StopBook(const StopBook&) = delete;
+    void operator=(const StopBook&) = delete;
+
+    bool empty() const { return index_.empty(); }
+    std::size_t size() const { return index_.size(); }
+    bool Contains(OrderId orderId) const { return index_.contains(orderId); }
+    const Order* Find(OrderId orderId) const;  // nullptr: not pending
+
+    // ! expects a Stop or StopLimit order with a stop price and an ID that is not pending yet.
+    void Add(const Order& order);
+    bool Cancel(OrderId orderId);  // false: not pending
+
+    // Would a trade anywhere within [low, high] trigger a stop? O(1)
+    bool Triggers(Price low, Price high) const {
+        return (!buys_.empty() && buys_.begin()->first <= high) || (!sells_.empty() && sells_.begin()->first >= low);
+    }
+
+    // Move the orders triggered by trades within [low, high] to the back of `triggered`: buy stops first, each side in trigger order.
+    void Collect(Price low, Price high, std::vector<Order>& triggered);
+
+    // Append the IDs of the owner's pending stops to `orderIds`. O(pending), for a dropped session only.
+    void CollectOwner(OwnerId owner, std::vector<OrderId>& orderIds) const;
+
+    // Every pending stop, buy stops then sell stops, each in trigger order -> the order a snapshot writes them in.
+    template <typename Visitor>
+    void ForEach(Visitor&& visitor) const {
+        for (const auto& [stopPrice, order] : buys_) visitor(order);
+        for (const auto& [stopPrice, order] : sells_) visitor(order);
+    }
+
+private:
+    // multimaps keep equal keys in insertion order -> time priority among the stops on one price.
+    using BuyStops = std::pmr::multimap<Price, Order, std::less<Price>>;  // lowest stop first: the first a rising market reaches
+    using SellStops = std::pmr::multimap<Price, Order, std::greater<Price>>;  // highest stop first: the first a falling market reaches
+
+    struct Location{
+        Side side_{ Side::Buy };
+        BuyStops::iterator buy_{};  // valid for side_ == Buy only
+        SellStops::iterator sell_{};  // valid for side_ == Sell only
+    };
+
+    BuyStops buys_;
+    SellStops sells_;
+    std::pmr::unordered_map<OrderId, Location> index_;  // ID -> its entry, to cancel in O(1)
+};
@@ -0,0 +1,29 @@
+#include <pthread.h>
+#include <sched.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "ThreadAffinity.h"
+
+bool PinCurrentThread(int cpu){
+    if (cpu < 0){
+        return true;
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+bool PreferLocalMemory(){
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    // ! straight through the syscall: <numaif.h> (and -lnuma) would be the only reason to depend on libnuma.
+    constexpr int MemoryPolicyLocal = 4;  // MPOL_LOCAL, since Linux 3.8
+    return syscall(SYS_set_mempolicy, MemoryPolicyLocal, nullptr, 0) == 0;
+#else
+    return false;
+#endif
+}
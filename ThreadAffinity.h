@@ -0,0 +1,22 @@
+#pragma once
+
+// Pin the calling thread to the given core. A negative cpu leaves the thread to the scheduler.
+// Returns false if the core could not be set (e.g., it does not exist on this machine).
+bool PinCurrentThread(int cpu);
+
+/*
+ * Allocate the calling thread's memory on the NUMA node it runs on, from now on (Linux: MPOL_LOCAL).
+ * That is the kernel's default anyway, unless the process was started under another policy (e.g., numactl --interleave).
+ * Pin first, then allocate and touch -> the pages land on the node of that core.
+ * Returns false if the policy could not be set, or on a platform without one.
+ */
+bool PreferLocalMemory();
+
+// Spin-wait hint for a busy-polling loop: lets the sibling hyper-thread run and saves power, without giving up the core.
+inline void CpuRelax(){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Types.h"
+#include "LevelInfo.h"
+
+/*
+ * The best levels of both sides of one book, as published by the book after every change to them
+ * (OrderBook::GetTopOfBook()). Flat and fixed-size, so it can be copied in one go out of a SeqLock.
+ */
+struct TopOfBook{
+    static constexpr std::size_t Depth = 5;  // levels per side
+
+    std::uint32_t bidLevels_{};  // levels filled in bids_ (best first), at most Depth
+    std::uint32_t askLevels_{};
+    LevelInfo bids_[Depth]{};
+    LevelInfo asks_[Depth]{};
+
+    bool HasBid() const { return bidLevels_ != 0; }
+    bool HasAsk() const { return askLevels_ != 0; }
+
+    // ! Only valid if that side is not empty.
+    const LevelInfo& BestBid() const { return bids_[0]; }
+    const LevelInfo& BestAsk() const { return asks_[0]; }
+};
+
+static_assert(sizeof(TopOfBook) == 88);
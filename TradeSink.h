@@ -0,0 +1,32 @@
+#pragma once
+#include <memory>  // for std::addressof
+#include <type_traits>
+
+#include "Trade.h"
+
+/*
+ * Non-owning reference to "something that takes a Trade": a lambda, a functor, a ring buffer writer...
+ *
+ * Two pointers wide and built without any allocation, so the book can hand every fill to it as it happens
+ * instead of collecting them in a Trades vector. It only refers to the callable -> the callable must outlive
+ * the call it is passed to (a temporary lambda in the argument list is fine).
+ */
+class TradeSink{
+public:
+    template <typename Callback>
+        requires (
+            !std::is_same_v<std::remove_cvref_t<Callback>, TradeSink> &&
+            !std::is_function_v<std::remove_reference_t<Callback>> &&  // wrap a plain function in a lambda
+            std::is_invocable_v<Callback&, const Trade&>
+        )
+    TradeSink(Callback&& callback)
+        : callback_{ const_cast<void*>(static_cast<const void*>(std::addressof(callback))) }
+        , emit_{ [](void* callback, const Trade& trade){ (*static_cast<std::remove_reference_t<Callback>*>(callback))(trade); } }
+    {}
+
+    void operator()(const Trade& trade) const { emit_(callback_, trade); }
+
+private:
+    void* callback_;
+    void (*emit_)(void*, const Trade&);
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <chrono>
 #include <cstdint>
 #include <limits>
 #include <vector>
@@ -9,6 +10,9 @@ enum class OrderType{
     FillOrKill,  // fill if we can, cancel otherwise.
     GoodForDay,  // Similar to the GTC -> need to cancel it based on the time.
     Market,  // gimme whatever price, but I want to be filled
+    GoodTillDate,  // GTC with an expiry -> cancelled by the book once its expiry time has passed.
+    Stop,  // held back until the market trades through its stop price, then a Market order.
+    StopLimit,  // same trigger, then a GoodTillCancel order at its (limit) price.
 };
 
 enum class Side{
@@ -20,8 +24,51 @@ using Price = std::int32_t;
 using Quantity = std::uint32_t;
 using OrderId = std::uint64_t;
 using OrderIds = std::vector<OrderId>;
+using SymbolId = std::uint32_t;
+
+// Session (or trader) an order belongs to -> mass cancel when it drops. NoOwner: not tagged.
+using OwnerId = std::uint32_t;
+inline constexpr OwnerId NoOwner = 0;
+
+// Wall-clock time, used for order expiry (GoodForDay cutoff, GoodTillDate).
+using Timestamp = std::chrono::system_clock::time_point;
+inline constexpr Timestamp NoExpiry = Timestamp::max();
+
+// Timestamps on disk: nanoseconds since the epoch, with INT64_MAX standing for NoExpiry.
+inline std::int64_t ToEpochNanoseconds(Timestamp time){
+    if (time == NoExpiry) return std::numeric_limits<std::int64_t>::max();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+inline Timestamp FromEpochNanoseconds(std::int64_t nanoseconds){
+    if (nanoseconds == std::numeric_limits<std::int64_t>::max()) return NoExpiry;
+    return Timestamp{ std::chrono::duration_cast<Timestamp::duration>(std::chrono::nanoseconds{ nanoseconds }) };
+}
+
+// Index of an order slot inside the OrderPool -> stays valid until the order leaves the book.
+using OrderHandle = std::uint32_t;
+inline constexpr OrderHandle InvalidOrderHandle = std::numeric_limits<OrderHandle>::max();
+
+/*
+ * What became of a command sent to the book. The public entry points return it instead of throwing,
+ * so the book builds (and behaves the same) with -fno-exceptions.
+ */
+enum class OrderResult : std::uint8_t{
+    Ok,  // applied: rested, traded (partially for a FAK), cancelled or amended
+    DuplicateOrderId,  // an order with this ID is already resting
+    UnknownOrderId,  // cancel or modify of an order that is not in the book (filled, cancelled, or never added)
+    InvalidQuantity,  // zero quantity on an add
+    InvalidPrice,  // a priced order (anything but Market) at Constants::InvalidPrice
+    NotExecuted,  // Market, FAK or FOK that could not trade on arrival -> killed, the book is unchanged
+    Malformed,  // not a command or order type the book knows, e.g., a corrupt record
+    RiskRejected,  // failed a pre-trade check (RiskPolicy.h): too large, priced outside the band, or over its owner's credit
+    SelfTrade,  // cancelled by self-trade prevention before (or after part of) it could trade against its own owner
+    NotOwner,  // cancel or modify sent on behalf of another owner than the order's -> the order is left as it was
+};
 
 struct Constants
 {
-    static const Price InvalidPrice = std::numeric_limits<Price>::quiet_NaN();  // Not a number
+    // ! Price is an integer -> no NaN to stand for "no price" (quiet_NaN() of an int is 0, a valid price).
+    // The lowest representable price instead: never a real tick, and it compares below every one of them.
+    static constexpr Price InvalidPrice = std::numeric_limits<Price>::min();
 };
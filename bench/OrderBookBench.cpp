@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "OrderBook.h"
+#include "OrderFlow.h"
+
+/*
+ * Micro benchmarks of the OrderBook hot paths.
+ *
+ * Every benchmark runs pre-generated commands against a prefilled book, so only the book is on the clock.
+ * When the batch runs out, the book and the next batch are rebuilt with the timer paused.
+ */
+namespace {
+    constexpr std::size_t BatchSize = 1 << 14;
+
+    // the fills are swallowed here, so no Trades vector is built on the timed path.
+    const auto DiscardTrade = [](const Trade& trade) { benchmark::DoNotOptimize(&trade); };
+
+    OrderBookConfig Backend(const OrderFlow& flow, bool ladder){
+        auto config = flow.BookConfig();
+        if (!ladder){
+            config.ladderLevels_ = 0;  // map-only book
+        }
+        return config;
+    }
+
+    // setup: anything else the book should hold before the batch runs, e.g., pending stops -> off the clock as well.
+    template <typename MakeBatch, typename Setup = void (*)(OrderBook&)>
+    void RunBatches(benchmark::State& state, const FlowParams& params, bool ladder, MakeBatch makeBatch, Setup setup = [](OrderBook&){}){
+        std::unique_ptr<OrderFlow> flow;
+        std::unique_ptr<OrderBook> book;
+        std::vector<OrderCommand> commands;
+        std::size_t next = 0;
+
+        auto Rebuild = [&]{
+            book.reset();
+            flow = std::make_unique<OrderFlow>(params);
+            book = std::make_unique<OrderBook>(Backend(*flow, ladder));
+            flow->Prefill(*book);
+            setup(*book);
+            commands = makeBatch(*flow);
+            next = 0;
+        };
+
+        Rebuild();
+        for (auto _ : state){
+            book->Apply(commands[next], DiscardTrade);
+            if (++next == commands.size()){
+                state.PauseTiming();
+                Rebuild();
+                state.ResumeTiming();
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    FlowParams Shape(const benchmark::State& state){
+        FlowParams params;
+        params.depth_ = static_cast<std::size_t>(state.range(0));
+        params.ordersPerLevel_ = static_cast<std::size_t>(state.range(1));
+        return params;
+    }
+
+    // Shuffled IDs of the orders placed by Prefill(): ids 1 .. 2 * depth * ordersPerLevel
+    std::vector<OrderId> PrefilledIds(const FlowParams& params){
+        std::vector<OrderId> ids(2 * params.depth_ * params.ordersPerLevel_);
+        for (std::size_t i = 0; i < ids.size(); ++i){
+            ids[i] = static_cast<OrderId>(i + 1);
+        }
+        std::shuffle(ids.begin(), ids.end(), std::mt19937_64{ params.seed_ });
+        return ids;
+    }
+}
+
+// args: depth, orders per level, ladder (0 = map only)
+static void BM_AddOrderPassive(benchmark::State& state){
+    const auto params = Shape(state);
+    RunBatches(state, params, state.range(2) != 0, [&](OrderFlow& flow){
+        std::vector<OrderCommand> commands;
+        for (std::size_t i = 0; i < BatchSize; ++i){
+            commands.push_back(flow.Passive(i % 2 ? Side::Buy : Side::Sell, i % params.depth_));
+        }
+        return commands;
+    });
+}
+BENCHMARK(BM_AddOrderPassive)
+    ->ArgNames({ "depth", "perLevel", "ladder" })
+    ->ArgsProduct({ { 8, 128 }, { 4, 64 }, { 0, 1 } });
+
+static void BM_CancelOrder(benchmark::State& state){
+    const auto params = Shape(state);
+    RunBatches(state, params, state.range(2) != 0, [&](OrderFlow&){
+        std::vector<OrderCommand> commands;
+        for (const OrderId orderId : PrefilledIds(params)){
+            commands.push_back(OrderCommand::Cancel(orderId));
+        }
+        return commands;
+    });
+}
+BENCHMARK(BM_CancelOrder)
+    ->ArgNames({ "depth", "perLevel", "ladder" })
+    ->ArgsProduct({ { 8, 128 }, { 4, 64 }, { 0, 1 } });
+
+static void BM_ModifyOrder(benchmark::State& state){
+    const auto params = Shape(state);
+    RunBatches(state, params, state.range(2) != 0, [&](OrderFlow&){
+        // move every prefilled order to another passive level on its own side (odd ids are bids, see Prefill())
+        std::vector<OrderCommand> commands;
+        std::size_t level = 0;
+        for (const OrderId orderId : PrefilledIds(params)){
+            const Side side = orderId % 2 ? Side::Buy : Side::Sell;
+            const auto offset = static_cast<Price>(++level % params.depth_ + 1);
+            const Price price = side == Side::Buy ? OrderFlow::MidPrice - offset : OrderFlow::MidPrice + offset;
+            commands.push_back(OrderCommand::Modify(OrderModify{ orderId, side, price, 5 }));
+        }
+        return commands;
+    });
+}
+BENCHMARK(BM_ModifyOrder)
+    ->ArgNames({ "depth", "perLevel", "ladder" })
+    ->ArgsProduct({ { 8, 128 }, { 4, 64 }, { 0, 1 } });
+
+// args: depth, orders per level, ladder, quantity of every aggressive order (how deep it sweeps)
+static void BM_MatchAggressive(benchmark::State& state){
+    const auto params = Shape(state);
+    const auto quantity = static_cast<Quantity>(state.range(3));
+
+    RunBatches(state, params, state.range(2) != 0, [&](OrderFlow&){
+        // stop well before the prefilled liquidity (>= 1 per order) could run out
+        const std::size_t count = std::max<std::size_t>(1, params.depth_ * params.ordersPerLevel_ / (2 * quantity));
+        std::vector<OrderCommand> commands;
+        for (std::size_t i = 0; i < count && i < BatchSize; ++i){
+            const Side side = i % 2 ? Side::Buy : Side::Sell;
+            const Price price = side == Side::Buy ? OrderFlow::MidPrice + 1'000 : OrderFlow::MidPrice - 1'000;
+            commands.push_back(OrderCommand::Add(Order{ OrderType::FillAndKill, 1'000'000 + i, side, price, quantity }));
+        }
+        return commands;
+    });
+}
+BENCHMARK(BM_MatchAggressive)
+    ->ArgNames({ "depth", "perLevel", "ladder", "qty" })
+    ->ArgsProduct({ { 128 }, { 4, 64 }, { 0, 1 }, { 1, 100 } });
+
+// args: pending stops, far from the market -> what matching pays for them when none triggers (should be nothing)
+static void BM_MatchWithPendingStops(benchmark::State& state){
+    FlowParams params;
+    params.depth_ = 128;
+    params.ordersPerLevel_ = 64;
+    const auto stops = static_cast<std::size_t>(state.range(0));
+
+    RunBatches(state, params, true, [&](OrderFlow&){
+        std::vector<OrderCommand> commands;
+        for (std::size_t i = 0; i < BatchSize; ++i){
+            const Side side = i % 2 ? Side::Buy : Side::Sell;
+            const Price price = side == Side::Buy ? OrderFlow::MidPrice + 1'000 : OrderFlow::MidPrice - 1'000;
+            commands.push_back(OrderCommand::Add(Order{ OrderType::FillAndKill, 1'000'000 + i, side, price, 1 }));
+        }
+        return commands;
+    }, [&](OrderBook& book){
+        for (std::size_t i = 0; i < stops; ++i){
+            const Side side = i % 2 ? Side::Buy : Side::Sell;
+            const auto offset = static_cast<Price>(5'000 + i % 1'000);
+            Order stop{ OrderType::Stop, 2'000'000 + i, side, Constants::InvalidPrice, 1 };
+            stop.SetStopPrice(side == Side::Buy ? OrderFlow::MidPrice + offset : OrderFlow::MidPrice - offset);
+            book.AddOrder(stop, DiscardTrade);
+        }
+    });
+}
+BENCHMARK(BM_MatchWithPendingStops)->ArgName("stops")->Arg(0)->Arg(1 << 10)->Arg(1 << 16);
+
+// args: orders in the opening flood (about half of them cross), auction (0 = each one matched on arrival)
+static void BM_OpeningCross(benchmark::State& state){
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const bool auction = state.range(1) != 0;
+
+    FlowParams params;
+    params.depth_ = 100;
+    params.ordersPerLevel_ = count / (4 * params.depth_) + 1;
+    const OrderFlow flow{ params };
+
+    // limit orders spread over +-100 ticks around the mid on both sides -> the bids and asks overlap by half.
+    std::mt19937_64 random{ params.seed_ };
+    std::vector<Order> orders;
+    orders.reserve(count);
+    for (std::size_t i = 0; i < count; ++i){
+        const Side side = i % 2 ? Side::Buy : Side::Sell;
+        const Price price = OrderFlow::MidPrice + static_cast<Price>(random() % 201) - 100;
+        orders.push_back(Order{ OrderType::GoodTillCancel, i + 1, side, price, static_cast<Quantity>(1 + random() % 100) });
+    }
+
+    for (auto _ : state){
+        state.PauseTiming();
+        auto book = std::make_unique<OrderBook>(flow.BookConfig());
+        state.ResumeTiming();
+
+        if (auction) book->BeginAuction();
+        for (const auto& order : orders){
+            book->AddOrder(order, DiscardTrade);
+        }
+        if (auction) book->Uncross(DiscardTrade);
+
+        state.PauseTiming();
+        book.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_OpeningCross)
+    ->ArgNames({ "orders", "auction" })
+    ->ArgsProduct({ { 1 << 10, 1 << 16 }, { 0, 1 } });
+
+// args: depth, orders per level, cancel %, aggressive %
+static void BM_MixedFlow(benchmark::State& state){
+    auto params = Shape(state);
+    params.cancelPercent_ = static_cast<unsigned>(state.range(2));
+    params.aggressivePercent_ = static_cast<unsigned>(state.range(3));
+
+    RunBatches(state, params, true, [&](OrderFlow& flow){
+        return flow.Generate(BatchSize);
+    });
+}
+BENCHMARK(BM_MixedFlow)
+    ->ArgNames({ "depth", "perLevel", "cancel%", "aggr%" })
+    ->ArgsProduct({ { 32 }, { 16 }, { 10, 45 }, { 5, 30 } });
+
+static void BM_GetOrderInfos(benchmark::State& state){
+    const auto params = Shape(state);
+    OrderFlow flow{ params };
+    OrderBook book{ Backend(flow, state.range(2) != 0) };
+    flow.Prefill(book);
+
+    for (auto _ : state){
+        benchmark::DoNotOptimize(book.GetOrderInfos());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetOrderInfos)
+    ->ArgNames({ "depth", "perLevel", "ladder" })
+    ->ArgsProduct({ { 8, 512 }, { 4, 64 }, { 0, 1 } });
+
+// args: depth, orders per level, levels requested
+static void BM_GetDepth(benchmark::State& state){
+    const auto params = Shape(state);
+    OrderFlow flow{ params };
+    OrderBook book{ Backend(flow, true) };
+    flow.Prefill(book);
+
+    std::vector<LevelInfo> levels(static_cast<std::size_t>(state.range(2)));
+    for (auto _ : state){
+        benchmark::DoNotOptimize(book.GetDepth(Side::Buy, levels));
+        benchmark::DoNotOptimize(book.GetDepth(Side::Sell, levels));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetDepth)
+    ->ArgNames({ "depth", "perLevel", "levels" })
+    ->ArgsProduct({ { 512 }, { 4 }, { 1, 10 } });
@@ -0,0 +1,151 @@
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "OrderBook.h"
+#include "OrderEntry.h"
+#include "OrderEntryDecoder.h"
+#include "OrderEntryGateway.h"
+#include "OrderFlow.h"
+
+/*
+ * Wire-to-trade benchmarks of the order-entry path: the mixed flow of OrderFlow, encoded as protocol messages.
+    * BM_DecodeAndApply -> datagrams already in memory, decoded and applied one ProcessBatch() per datagram
+    * BM_WireToTrade -> the same datagrams sent over loopback UDP and taken in by an OrderEntryGateway
+ * Items are the commands applied.
+ */
+namespace {
+    constexpr std::uint32_t Session = 1;
+    constexpr std::size_t Datagrams = 1 << 12;
+
+    const auto DiscardTrade = [](const Trade& trade) { benchmark::DoNotOptimize(&trade); };
+
+    template <typename Message>
+    void Append(std::vector<std::byte>& datagram, const Message& message){
+        const auto size = datagram.size();
+        datagram.resize(size + sizeof(Message));
+        std::memcpy(datagram.data() + size, &message, sizeof(Message));
+    }
+
+    void Encode(std::vector<std::byte>& datagram, const OrderCommand& command, std::uint64_t sequence){
+        switch (command.type_){
+            case CommandType::Add:
+                Append(datagram, OrderEntry::NewOrder(
+                    Session, sequence, 0, command.orderType_, command.orderId_, command.side_, command.price_, command.quantity_, command.expiry_
+                ));
+                break;
+            case CommandType::Cancel:
+                Append(datagram, OrderEntry::Cancel(Session, sequence, 0, command.orderId_));
+                break;
+            case CommandType::Modify:
+                Append(datagram, OrderEntry::Modify(Session, sequence, 0, command.orderId_, command.side_, command.price_, command.quantity_));
+                break;
+            case CommandType::BeginAuction:
+            case CommandType::Uncross:
+                break;  // not on the wire, and never in the flow
+        }
+    }
+
+    // `count` datagrams of `perDatagram` messages each, sequenced from 1 on.
+    std::vector<std::vector<std::byte>> EncodeFlow(OrderFlow& flow, std::size_t count, std::size_t perDatagram){
+        std::vector<std::vector<std::byte>> datagrams(count);
+        std::uint64_t sequence = 0;
+        for (auto& datagram : datagrams){
+            for (std::size_t i = 0; i < perDatagram; ++i){
+                Encode(datagram, flow.Next(), ++sequence);
+            }
+        }
+        return datagrams;
+    }
+
+    FlowParams Mixed(){
+        FlowParams params;
+        params.depth_ = 32;
+        params.ordersPerLevel_ = 16;
+        params.cancelPercent_ = 40;
+        params.aggressivePercent_ = 10;
+        return params;
+    }
+}
+
+// args: messages per datagram
+static void BM_DecodeAndApply(benchmark::State& state){
+    const auto perDatagram = static_cast<std::size_t>(state.range(0));
+    std::unique_ptr<OrderFlow> flow;
+    std::unique_ptr<OrderBook> book;
+    std::unique_ptr<OrderEntryDecoder> decoder;
+    std::vector<std::vector<std::byte>> datagrams;
+    std::vector<OrderCommand> batch;
+    batch.reserve(perDatagram);
+    std::size_t next = 0;
+
+    auto Rebuild = [&]{
+        book.reset();
+        flow = std::make_unique<OrderFlow>(Mixed());
+        book = std::make_unique<OrderBook>(flow->BookConfig());
+        flow->Prefill(*book);
+        decoder = std::make_unique<OrderEntryDecoder>(Session);
+        datagrams = EncodeFlow(*flow, Datagrams, perDatagram);
+        next = 0;
+    };
+
+    Rebuild();
+    for (auto _ : state){
+        batch.clear();
+        decoder->Decode(datagrams[next], [&](SymbolId, const OrderCommand& command){ batch.push_back(command); });
+        book->ProcessBatch(batch, DiscardTrade);
+        if (++next == datagrams.size()){
+            state.PauseTiming();
+            Rebuild();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(perDatagram));
+}
+BENCHMARK(BM_DecodeAndApply)->ArgName("perDatagram")->Arg(1)->Arg(16);
+
+// args: messages per datagram. Timed from the send() to the last fill of the datagram.
+static void BM_WireToTrade(benchmark::State& state){
+    const auto perDatagram = static_cast<std::size_t>(state.range(0));
+
+    OrderEntryGatewayConfig config;
+    config.address_ = "127.0.0.1";
+    config.batch_ = 1;  // one datagram in flight at a time -> latency, not throughput
+    auto gateway = OrderEntryGateway::Open(config);
+
+    const int client = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(gateway ? gateway->Port() : 0);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (!gateway || client < 0 || connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0){
+        state.SkipWithError("cannot set up the loopback socket pair");
+        if (client >= 0) close(client);
+        return;
+    }
+
+    OrderFlow flow{ Mixed() };
+    OrderBook book{ flow.BookConfig() };
+    flow.Prefill(book);
+    // sequences run on across batches: the gateway's decoder keeps its per-session state.
+    const auto datagrams = EncodeFlow(flow, Datagrams * 16, perDatagram);
+    std::size_t next = 0;
+
+    for (auto _ : state){
+        if (next == datagrams.size()) break;  // the flow is used up (the gateway cannot be rewound)
+        const auto& datagram = datagrams[next++];
+        send(client, datagram.data(), datagram.size(), 0);
+        while (gateway->Poll(book, DiscardTrade) == 0){}
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(perDatagram));
+    close(client);
+}
+BENCHMARK(BM_WireToTrade)->ArgName("perDatagram")->Arg(1)->Arg(16)->Iterations(50'000);
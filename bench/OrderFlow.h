@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "OrderBook.h"
+#include "OrderCommand.h"
+
+/*
+ * Deterministic synthetic order flow around a fixed mid price, shared by the benchmarks.
+ *
+ * Passive orders rest within `depth` ticks of the mid on either side, aggressive ones cross the whole book,
+ * and cancels hit a random order issued earlier (which may already be filled -> then it is a no-op, as in real flow).
+ */
+struct FlowParams{
+    std::size_t depth_{ 16 };  // price levels per side
+    std::size_t ordersPerLevel_{ 8 };  // resting orders per level after Prefill()
+    unsigned cancelPercent_{ 30 };  // share of Next() commands that are cancels
+    unsigned aggressivePercent_{ 10 };  // share of Next() commands that are crossing adds
+    std::uint64_t seed_{ 42 };
+};
+
+class OrderFlow{
+public:
+    static constexpr Price MidPrice = 10'000;
+
+    explicit OrderFlow(const FlowParams& params) : params_{ params }, random_{ params.seed_ } {}
+
+    // Ladder window covering every price the flow can produce.
+    OrderBookConfig BookConfig() const {
+        OrderBookConfig config;
+        config.expectedOrders_ = 2 * params_.depth_ * params_.ordersPerLevel_ * 2;
+        config.ladderBasePrice_ = MidPrice - static_cast<Price>(params_.depth_);
+        config.ladderTickSize_ = 1;
+        config.ladderLevels_ = 2 * params_.depth_ + 1;
+        return config;
+    }
+
+    // Fill both sides: depth_ levels of ordersPerLevel_ orders each.
+    void Prefill(OrderBook& book){
+        for (std::size_t level = 0; level < params_.depth_; ++level){
+            for (std::size_t i = 0; i < params_.ordersPerLevel_; ++i){
+                book.Apply(Passive(Side::Buy, level));
+                book.Apply(Passive(Side::Sell, level));
+            }
+        }
+    }
+
+    OrderCommand Next(){
+        const unsigned roll = Uniform(100);
+
+        if (roll < params_.cancelPercent_ && !live_.empty()){
+            // swap-remove a random live order id
+            const std::size_t index = Uniform(live_.size());
+            const OrderId orderId = live_[index];
+            live_[index] = live_.back();
+            live_.pop_back();
+            return OrderCommand::Cancel(orderId);
+        }
+
+        const Side side = Uniform(2) == 0 ? Side::Buy : Side::Sell;
+        if (roll < params_.cancelPercent_ + params_.aggressivePercent_){
+            return Aggressive(side);
+        }
+        return Passive(side, Uniform(params_.depth_));
+    }
+
+    OrderCommand Passive(Side side, std::size_t level){
+        const auto offset = static_cast<Price>(level + 1);
+        const Price price = side == Side::Buy ? MidPrice - offset : MidPrice + offset;
+        live_.push_back(nextOrderId_);
+        return OrderCommand::Add(Order{ OrderType::GoodTillCancel, nextOrderId_++, side, price, 1 + Uniform(10) });
+    }
+
+    OrderCommand Aggressive(Side side){
+        // FAK through the far end of the opposite side, so it never rests.
+        const auto offset = static_cast<Price>(params_.depth_);
+        const Price price = side == Side::Buy ? MidPrice + offset : MidPrice - offset;
+        return OrderCommand::Add(Order{ OrderType::FillAndKill, nextOrderId_++, side, price, 1 + Uniform(20) });
+    }
+
+    std::vector<OrderCommand> Generate(std::size_t count){
+        std::vector<OrderCommand> commands;
+        commands.reserve(count);
+        for (std::size_t i = 0; i < count; ++i){
+            commands.push_back(Next());
+        }
+        return commands;
+    }
+
+private:
+    std::uint32_t Uniform(std::size_t bound){
+        return static_cast<std::uint32_t>(std::uniform_int_distribution<std::size_t>{ 0, bound - 1 }(random_));
+    }
+
+    FlowParams params_;
+    std::mt19937_64 random_;
+    OrderId nextOrderId_{ 1 };
+    std::vector<OrderId> live_;
+};
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "OrderBook.h"
+#include "OrderFlow.h"
+
+/*
+ * Macro benchmark: replay a long deterministic flow through one book and time every command on its own.
+ * Reports the throughput plus the p50 / p99 / p99.9 latency of a single command (steady_clock, so the
+ * percentiles include ~20ns of clock overhead).
+ */
+namespace {
+    constexpr std::size_t ReplayLength = 1'000'000;
+
+    const auto DiscardTrade = [](const Trade& trade) { benchmark::DoNotOptimize(&trade); };
+
+    double Percentile(const std::vector<std::int64_t>& sorted, double fraction){
+        const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1));
+        return static_cast<double>(sorted[index]);
+    }
+}
+
+// args: ladder (0 = map only), single writer (0 = locked book)
+static void BM_Replay(benchmark::State& state){
+    FlowParams params;
+    params.depth_ = 32;
+    params.ordersPerLevel_ = 16;
+    params.cancelPercent_ = 40;
+    params.aggressivePercent_ = 10;
+
+    std::vector<std::int64_t> latencies;
+    latencies.reserve(ReplayLength * state.max_iterations);
+
+    for (auto _ : state){
+        state.PauseTiming();
+        OrderFlow flow{ params };
+        auto config = flow.BookConfig();
+        if (state.range(0) == 0){
+            config.ladderLevels_ = 0;
+        }
+        config.singleWriter_ = state.range(1) != 0;
+        auto book = std::make_unique<OrderBook>(config);
+        flow.Prefill(*book);
+        const auto commands = flow.Generate(ReplayLength);
+        state.ResumeTiming();
+
+        for (const auto& command : commands){
+            const auto start = std::chrono::steady_clock::now();
+            book->Apply(command, DiscardTrade);
+            const auto end = std::chrono::steady_clock::now();
+            latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+
+        state.PauseTiming();
+        book.reset();  // the prune thread is joined off the clock
+        state.ResumeTiming();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ReplayLength));
+    state.counters["p50_ns"] = Percentile(latencies, 0.50);
+    state.counters["p99_ns"] = Percentile(latencies, 0.99);
+    state.counters["p99.9_ns"] = Percentile(latencies, 0.999);
+    state.counters["max_ns"] = static_cast<double>(latencies.back());
+}
+BENCHMARK(BM_Replay)
+    ->ArgNames({ "ladder", "singleWriter" })
+    ->ArgsProduct({ { 0, 1 }, { 0, 1 } })
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
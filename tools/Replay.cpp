@@ -0,0 +1,299 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "OrderBook.h"
+#include "Journal.h"
+#include "LatencyHistogram.h"
+#include "Instrumentation.h"
+#include "OrderFlow.h"
+
+/*
+ * Deterministic replay of a captured command log (a Journal file) through one OrderBook.
+ *
+ *  replay <journal> [options]
+ *      --speed X              0 (default) = as fast as possible, 1 = recorded timing, 2 = twice as fast, ...
+ *      --golden FILE          compare every trade against FILE, fail on the first difference
+ *      --write-golden FILE    write every trade to FILE, to be used as the golden output later on
+ *      --ladder BASE:TICK:N   price ladder window of the book (default: map only)
+ *      --locked               drive a locked book instead of a single-writer one
+ *
+ *  replay --generate <journal> <commands> [--rate PER_SECOND] [--seed N]
+ *      write a synthetic flow (bench/OrderFlow.h), timestamped at the given rate, to replay later.
+ *
+ * The same log and options always produce the same trades, so the golden file doubles as a regression check of the matching.
+ * Exit status: 0 = ok, 1 = golden mismatch, 2 = usage or I/O error.
+ */
+namespace {
+    struct Options{
+        std::string journal_;
+        double speed_{ 0.0 };
+        std::string golden_;
+        std::string writeGolden_;
+        Price ladderBase_{ 0 };
+        Price ladderTick_{ 1 };
+        std::size_t ladderLevels_{ 0 };
+        bool locked_{ false };
+
+        bool generate_{ false };
+        std::size_t commands_{ 0 };
+        double rate_{ 1'000'000.0 };
+        std::uint64_t seed_{ 42 };
+    };
+
+    struct TradeRecord{
+        std::uint64_t sequence_;  // journal record that caused it
+        Trade trade_;
+    };
+
+    int Usage(){
+        std::cerr << "usage: replay <journal> [--speed X] [--golden FILE] [--write-golden FILE] [--ladder BASE:TICK:N] [--locked]\n"
+                  << "       replay --generate <journal> <commands> [--rate PER_SECOND] [--seed N]\n";
+        return 2;
+    }
+
+    bool ParseLadder(const std::string& text, Options& options){
+        const char* cursor = text.c_str();
+        char* end = nullptr;
+        options.ladderBase_ = static_cast<Price>(std::strtol(cursor, &end, 10));
+        if (*end != ':') return false;
+        options.ladderTick_ = static_cast<Price>(std::strtol(end + 1, &end, 10));
+        if (*end != ':') return false;
+        options.ladderLevels_ = std::strtoull(end + 1, &end, 10);
+        return *end == '\0' && options.ladderTick_ > 0;
+    }
+
+    bool Parse(int argc, char** argv, Options& options){
+        int i = 1;
+        if (i < argc && std::strcmp(argv[i], "--generate") == 0){
+            if (argc < 4) return false;
+            options.generate_ = true;
+            options.journal_ = argv[2];
+            options.commands_ = std::strtoull(argv[3], nullptr, 10);
+            i = 4;
+        } else if (i < argc && argv[i][0] != '-'){
+            options.journal_ = argv[i++];
+        } else {
+            return false;
+        }
+
+        for (; i < argc; ++i){
+            const std::string flag = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (flag == "--locked"){
+                options.locked_ = true;
+            } else if (!hasValue){
+                return false;
+            } else if (flag == "--speed"){
+                options.speed_ = std::strtod(argv[++i], nullptr);
+            } else if (flag == "--golden"){
+                options.golden_ = argv[++i];
+            } else if (flag == "--write-golden"){
+                options.writeGolden_ = argv[++i];
+            } else if (flag == "--ladder"){
+                if (!ParseLadder(argv[++i], options)) return false;
+            } else if (flag == "--rate"){
+                options.rate_ = std::strtod(argv[++i], nullptr);
+            } else if (flag == "--seed"){
+                options.seed_ = std::strtoull(argv[++i], nullptr, 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int Generate(const Options& options){
+        std::remove(options.journal_.c_str());
+        auto journal = Journal::Open(options.journal_, JournalConfig{ 1 << 16, false });
+        if (!journal){
+            std::cerr << "cannot create " << options.journal_ << "\n";
+            return 2;
+        }
+
+        FlowParams params;
+        params.depth_ = 32;
+        params.ordersPerLevel_ = 16;
+        params.cancelPercent_ = 40;
+        params.aggressivePercent_ = 10;
+        params.seed_ = options.seed_;
+        OrderFlow flow{ params };
+
+        // evenly spaced at the requested rate, starting now
+        const auto start = std::chrono::system_clock::now();
+        const auto spacing = std::chrono::nanoseconds{ static_cast<std::int64_t>(1e9 / (options.rate_ > 0 ? options.rate_ : 1e6)) };
+        std::uint64_t written = 0;
+        auto Write = [&](const OrderCommand& command){
+            journal->Append(command, start + spacing * written++);
+        };
+
+        for (std::size_t level = 0; level < params.depth_; ++level){
+            for (std::size_t i = 0; i < params.ordersPerLevel_; ++i){
+                Write(flow.Passive(Side::Buy, level));
+                Write(flow.Passive(Side::Sell, level));
+            }
+        }
+        for (std::size_t i = 0; i < options.commands_; ++i){
+            Write(flow.Next());
+        }
+
+        if (!journal->Flush()){
+            std::cerr << "cannot write " << options.journal_ << "\n";
+            return 2;
+        }
+        std::cout << "wrote " << written << " commands to " << options.journal_ << "\n";
+        return 0;
+    }
+
+    std::ostream& operator<<(std::ostream& out, const TradeRecord& record){
+        const auto& bid = record.trade_.GetBidTrade();
+        const auto& ask = record.trade_.GetAskTrade();
+        return out << record.sequence_ << ' '
+                   << bid.orderId_ << ' ' << bid.price_ << ' '
+                   << ask.orderId_ << ' ' << ask.price_ << ' '
+                   << bid.quantity_;
+    }
+
+    // Returns the number of the first differing line (1-based), 0 if the trades match the file exactly.
+    std::uint64_t CompareGolden(const std::string& path, const std::vector<TradeRecord>& trades, bool& readable){
+        std::ifstream golden{ path };
+        readable = static_cast<bool>(golden);
+        if (!readable) return 0;
+
+        std::string expected;
+        std::uint64_t line = 0;
+        for (const auto& trade : trades){
+            ++line;
+            std::ostringstream actual;
+            actual << trade;
+            if (!std::getline(golden, expected) || expected != actual.str()){
+                std::cerr << "golden mismatch at line " << line << ":\n"
+                          << "  expected: " << (golden ? expected : std::string{ "<end of file>" }) << "\n"
+                          << "  actual:   " << actual.str() << "\n";
+                return line;
+            }
+        }
+        if (std::getline(golden, expected)){
+            std::cerr << "golden mismatch at line " << line + 1 << ": expected more trades (" << expected << ")\n";
+            return line + 1;
+        }
+        return 0;
+    }
+
+    void PrintHistogram(const char* name, const LatencyHistogram& histogram){
+        std::cout << std::left << std::setw(10) << name << std::right
+                  << " p50 " << std::setw(7) << histogram.Percentile(0.50)
+                  << "  p90 " << std::setw(7) << histogram.Percentile(0.90)
+                  << "  p99 " << std::setw(7) << histogram.Percentile(0.99)
+                  << "  p99.9 " << std::setw(7) << histogram.Percentile(0.999)
+                  << "  p99.99 " << std::setw(8) << histogram.Percentile(0.9999)
+                  << "  max " << std::setw(9) << histogram.Max()
+                  << "  mean " << std::fixed << std::setprecision(1) << histogram.Mean() << " ns\n";
+    }
+
+    int Replay(const Options& options){
+        const auto view = JournalView::Open(options.journal_);
+        if (!view){
+            std::cerr << "cannot map " << options.journal_ << "\n";
+            return 2;
+        }
+        const auto records = view->Records();
+
+        OrderBookConfig config;
+        config.expectedOrders_ = records.size();
+        config.ladderBasePrice_ = options.ladderBase_;
+        config.ladderTickSize_ = options.ladderTick_;
+        config.ladderLevels_ = options.ladderLevels_;
+        config.singleWriter_ = !options.locked_;
+        OrderBook book{ config };
+
+        const bool keepTrades = !options.golden_.empty() || !options.writeGolden_.empty();
+        std::vector<TradeRecord> trades;
+        std::uint64_t tradeCount = 0;
+        std::uint64_t sequence = 0;
+        auto OnTrade = [&](const Trade& trade){
+            ++tradeCount;
+            if (keepTrades) trades.push_back(TradeRecord{ sequence, trade });
+        };
+
+        // service: time spent inside the book; response: from the recorded arrival (paced replay only), queueing included.
+        LatencyHistogram service;
+        LatencyHistogram response;
+        const bool paced = options.speed_ > 0 && !records.empty();
+        const std::int64_t firstTimestamp = records.empty() ? 0 : records.front().timestamp_;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& record : records){
+            sequence = record.sequence_;
+
+            auto arrival = start;
+            if (paced){
+                arrival += std::chrono::nanoseconds{
+                    static_cast<std::int64_t>(static_cast<double>(record.timestamp_ - firstTimestamp) / options.speed_)
+                };
+                while (std::chrono::steady_clock::now() < arrival){}  // spin -> sub-microsecond pacing
+            }
+
+            const auto before = std::chrono::steady_clock::now();
+            book.Apply(record.Decode(), OnTrade);
+            const auto after = std::chrono::steady_clock::now();
+
+            service.Record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count()));
+            if (paced){
+                response.Record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(after - arrival).count()));
+            }
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << records.size() << " commands, " << tradeCount << " trades, " << book.Size() << " orders resting\n"
+                  << std::fixed << std::setprecision(3) << elapsed << " s, "
+                  << std::setprecision(0) << (elapsed > 0 ? static_cast<double>(records.size()) / elapsed : 0.0) << " commands/s\n";
+        PrintHistogram("service", service);
+        if (paced){
+            PrintHistogram("response", response);
+        }
+        if (Instrumentation::Enabled){
+            std::cout << Instrumentation::Report();  // where the time goes inside the book
+        }
+
+        if (!options.writeGolden_.empty()){
+            std::ofstream golden{ options.writeGolden_ };
+            for (const auto& trade : trades){
+                golden << trade << '\n';
+            }
+            if (!golden){
+                std::cerr << "cannot write " << options.writeGolden_ << "\n";
+                return 2;
+            }
+            std::cout << "wrote " << trades.size() << " trades to " << options.writeGolden_ << "\n";
+        }
+
+        if (!options.golden_.empty()){
+            bool readable = false;
+            if (CompareGolden(options.golden_, trades, readable) != 0) return 1;
+            if (!readable){
+                std::cerr << "cannot read " << options.golden_ << "\n";
+                return 2;
+            }
+            std::cout << "golden: " << trades.size() << " trades match\n";
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv){
+    Options options;
+    if (!Parse(argc, argv, options)) return Usage();
+
+    return options.generate_ ? Generate(options) : Replay(options);
+}